@@ -3,6 +3,43 @@
 #include <ESP8266WebServer.h>
 #include <LittleFS.h>
 
+/**
+ * @brief Sends each write as a chunk of the response.
+ *        `aalec_pug()` already writes the HTML in chunks of
+ *        `AALEC_PUG_OUTPUT_CHUNK_SIZE` bytes, so there is no buffer here
+ */
+class ChunkedResponse : public Print {
+   public:
+    /**
+     * @brief Construct a new ChunkedResponse object and send the headers
+     *
+     * @param contentType The content type of the response
+     */
+    ChunkedResponse(String contentType);
+
+    /**
+     * @brief Send the last chunk and end the response
+     */
+    ~ChunkedResponse();
+
+    /**
+     * @brief Send a byte as a chunk
+     *
+     * @param value The byte
+     * @return size_t Amount of sent bytes
+     */
+    size_t write(uint8_t value) override;
+
+    /**
+     * @brief Send bytes as a chunk
+     *
+     * @param buffer The bytes
+     * @param size Amount of bytes
+     * @return size_t Amount of sent bytes
+     */
+    size_t write(const uint8_t *buffer, size_t size) override;
+};
+
 /**
  * @brief Get the Mime Type of a file based on the file extension
  *
@@ -11,6 +48,23 @@
  */
 String getMimeType(String path);
 
+/**
+ * @brief Check if the client already has the current version of the response,
+ *        sends a 304 response with the tag if it has
+ *
+ * @param etag The entity tag of the current version
+ * @return bool Wether the 304 response was sent
+ */
+bool sendNotModified(String etag);
+
+/**
+ * @brief Format a time as HTTP date, eg: "Sun, 06 Nov 1994 08:49:37 GMT"
+ *
+ * @param time Seconds since 1970
+ * @return String The date
+ */
+String httpDate(time_t time);
+
 /**
  * @brief Handle an incoming request
  */
@@ -24,12 +78,21 @@ void handleRequest();
 void sendIndex(String path);
 
 /**
- * @brief Compile a pug file and send it to the client
+ * @brief Compile a pug file and send it to the client as a chunked response,
+ *        without writing it to the file system
  *
  * @param path Path to the pug file
  */
 void sendPug(String path);
 
+/**
+ * @brief Send the current values of the GPIOs a pug file uses as JSON,
+ *        see `data/live.js`
+ *
+ * @param path Path to the pug file
+ */
+void sendValues(String path);
+
 /**
  * @brief Try to send a file to the client
  *
@@ -45,6 +108,9 @@ const String password = "your wifi password";
 // The web server
 ESP8266WebServer server(80);
 
+// Memory for the strings of compiles, so they don't fragment the heap
+uint8_t arenaBuffer[4096];
+
 /**
  * @brief The setup
  */
@@ -52,6 +118,9 @@ void setup() {
     // Init aalec
     aalec.init();
 
+    // Compiles use the buffer first, `compileArena.peak()` tells how much they need
+    compileArena.setBuffer(arenaBuffer, sizeof(arenaBuffer));
+
     // Mount LittleFS
     Serial.println("Mounting LittleFS...");
 
@@ -81,18 +150,82 @@ void setup() {
     Serial.println("Starting server...");
 
     server.onNotFound(handleRequest);
+
+    // Needed to answer requests for pages the client already has
+    const char *headers[] = {"If-None-Match"};
+    server.collectHeaders(headers, 1);
     server.begin();
 
     Serial.println("Server started");
+
+    // Read the slow temperature and humidity sensor in the background,
+    // so pages don't wait for it
+    gpioSampler.setInterval(GPIOId::Temp, 2000);
+    gpioSampler.setInterval(GPIOId::Humidity, 2000);
+
+    // Keep up to 16 KB of rendered pages, small changes of the analog value
+    // still use the cached page
+    outputCache.setBudget(16384);
+    outputCache.setQuantization(GPIOId::Analog, 16, 4);
+
+    // Mark the GPIO values in the pages, so `data/live.js` can update them
+    aalec_pug_tag_values(true);
 }
 
 /**
  * @brief Main loop
  */
 void loop() {
+    gpioSampler.update();
     server.handleClient();
 }
 
+ChunkedResponse::ChunkedResponse(String contentType) {
+    // A response of unknown length is sent in chunks
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, contentType, "");
+}
+
+ChunkedResponse::~ChunkedResponse() {
+    // An empty chunk ends the response
+    server.sendContent("");
+}
+
+size_t ChunkedResponse::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t ChunkedResponse::write(const uint8_t *buffer, size_t size) {
+    // An empty chunk would end the response
+    if (size == 0) {
+        return 0;
+    }
+
+    server.sendContent((const char *)buffer, size);
+
+    return size;
+}
+
+bool sendNotModified(String etag) {
+    // The client sends the tags of the versions it has cached
+    String tags = server.header("If-None-Match");
+    if (tags.indexOf(etag) < 0 && tags != "*") {
+        return false;
+    }
+
+    server.sendHeader("ETag", etag);
+    server.send(304);
+
+    return true;
+}
+
+String httpDate(time_t time) {
+    char date[32];
+    strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", gmtime(&time));
+
+    return String(date);
+}
+
 String getMimeType(String path) {
     if (path.endsWith(".html")) {
         return "text/html";
@@ -161,46 +294,43 @@ void sendPug(String path) {
     // Close the file
     pugFile.close();
 
-    // Create the compiled file path
-    String outFilePath = path + ".html";
-
-    // Compile the pug file
-    if (!aalec_pug(path, outFilePath)) {
-        // Failed to compile the pug file
-        server.send(
-            500,
-            "text/plain",
-            "Failed to compile PUG file '" + path + "'"
-        );
+    // Only the values were requested, eg: "/index.pug?values"
+    if (server.hasArg("values")) {
+        sendValues(path);
         return;
     }
 
-    // Open the compiled file
-    File outFile = LittleFS.open(outFilePath, "r");
-
-    // Check if the compiled file exists and is a file
-    if (!outFile.isFile()) {
-        // Failed to open the compiled file
-
-        // Close the file
-        outFile.close();
+    // The tag depends on the source and the GPIO values, render the page
+    // with the same values so it matches the tag
+    GPIOSnapshot gpios = GPIOSnapshot(gpioSampler);
+    String etag;
+    if (aalec_pug_etag(path, gpios, etag)) {
+        // The client already has this page, don't render it
+        if (sendNotModified(etag)) {
+            return;
+        }
+
+        server.sendHeader("ETag", etag);
+    }
 
-        // Send a 500 error
-        server.send(
-            500,
-            "text/plain",
-            "Failed to read compiled PUG file '" + outFilePath + "'"
-        );
+    // Compile the pug file directly into the response
+    ChunkedResponse response("text/html");
+    if (!aalec_pug(path, response, gpios)) {
+        // The headers are already sent, the details are in the serial output
+        Serial.printf("Failed to compile PUG file '%s'\n", path.c_str());
+    }
+}
 
-        // Early return
+void sendValues(String path) {
+    // The JSON is only a few bytes, send it at once
+    StreamString json;
+    if (!aalec_pug_values(path, json)) {
+        server.send(500, "text/plain", "Failed to compile PUG file");
         return;
     }
 
-    // Send the compiled file
-    server.streamFile(outFile, "text/html");
-
-    // Close the file
-    outFile.close();
+    server.sendHeader("Cache-Control", "no-cache");
+    server.send(200, "application/json", json);
 }
 
 void sendFile(String path) {
@@ -221,6 +351,23 @@ void sendFile(String path) {
         return;
     }
 
+    // The client already has this version of the file, don't send it
+    String etag;
+    if (aalec_pug_file_etag(path, etag)) {
+        if (sendNotModified(etag)) {
+            file.close();
+            return;
+        }
+
+        server.sendHeader("ETag", etag);
+    }
+
+    // Files without a timestamp have no date
+    time_t lastWrite = file.getLastWrite();
+    if (lastWrite != 0) {
+        server.sendHeader("Last-Modified", httpDate(lastWrite));
+    }
+
     // Send the file
     server.streamFile(file, getMimeType(path));
 
@@ -0,0 +1,38 @@
+// Updates the GPIO values of a page in place, add it with:
+// script(src="/live.js")
+(function () {
+    var last = null;
+
+    setInterval(function () {
+        fetch(location.pathname + "?values")
+            .then(function (response) {
+                return response.json();
+            })
+            .then(function (values) {
+                var reload = values.reload || [];
+                delete values.reload;
+
+                for (var key in values) {
+                    var elements = document.querySelectorAll(
+                        '[data-io="' + key + '"]'
+                    );
+                    var changed = last != null && last[key] != values[key];
+
+                    // A value that decides which parts of the page are
+                    // shown, or isn't shown itself, needs the whole page
+                    var whole =
+                        reload.indexOf(key) != -1 || elements.length == 0;
+                    if (changed && whole) {
+                        location.reload();
+                        return;
+                    }
+
+                    elements.forEach(function (element) {
+                        element.textContent = values[key];
+                    });
+                }
+
+                last = values;
+            });
+    }, 2000);
+})();
@@ -0,0 +1,447 @@
+/**
+ * End to end benchmark of the library on the host.
+ * Generates a corpus of templates, compiles and renders each of them
+ * and reports the throughput, allocations and peak heap per case.
+ *
+ * Usage: aalec_pug_benchmark [--iterations N] [--scale N] [--depth N]
+ *                            [--case NAME] [--root DIR] [--dht-latency US]
+ */
+#include <AALeC-V2.h>
+#include <AALeC-pug.h>
+#include <LittleFS.h>
+
+#include "support.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A template of the corpus
+ */
+class BenchmarkCase {
+   public:
+    /**
+     * @brief Name of the case, eg: "flat"
+     */
+    std::string name;
+
+    /**
+     * @brief Path of the page in the file system
+     */
+    std::string path;
+
+    /**
+     * @brief Lines of the page and its included files, per inclusion
+     */
+    size_t lines;
+
+    /**
+     * @brief Bytes of the page and its included files, per inclusion
+     */
+    size_t bytes;
+};
+
+/**
+ * @brief Result of running one case in one mode
+ */
+class BenchmarkResult {
+   public:
+    /**
+     * @brief Amount of runs
+     */
+    size_t runs;
+
+    /**
+     * @brief Time of all runs in seconds
+     */
+    double seconds;
+
+    /**
+     * @brief Bytes of HTML of one run
+     */
+    size_t outputBytes;
+
+    /**
+     * @brief Allocations of all runs
+     */
+    uint64_t allocations;
+
+    /**
+     * @brief Most bytes one run allocated at once
+     */
+    size_t peakHeap;
+};
+
+/**
+ * @brief Options of the command line
+ */
+class BenchmarkOptions {
+   public:
+    size_t iterations = 50;
+    size_t scale = 4;
+    size_t depth = 100;
+    std::string only;
+    std::string root;
+    unsigned long dhtLatencyUs = 0;
+};
+
+/**
+ * @brief Count the lines and bytes of a page with its included files,
+ *        every inclusion counts again
+ *
+ * @param root The file system root on the host
+ * @param path Path in the file system
+ * @param lines Gets the lines added
+ * @param bytes Gets the bytes added
+ */
+static void measure(
+    const std::string &root,
+    const std::string &path,
+    size_t &lines,
+    size_t &bytes
+) {
+    std::ifstream file = std::ifstream(root + path, std::ios::binary);
+    std::string line;
+    bool isPug = path.size() > 4 && path.substr(path.size() - 4) == ".pug";
+    while (std::getline(file, line)) {
+        lines++;
+        bytes += line.size() + 1;
+
+        size_t start = line.find_first_not_of(" \t");
+        if (!isPug || start == std::string::npos
+            || line.compare(start, 8, "include ") != 0) {
+            continue;
+        }
+
+        // Paths are relative to the including file or to the root
+        std::string include = line.substr(start + 8);
+        if (include[0] != '/') {
+            include = path.substr(0, path.rfind('/') + 1) + include;
+        }
+        measure(root, include, lines, bytes);
+    }
+}
+
+/**
+ * @brief Generate the templates of the corpus
+ *
+ * @param root The file system root on the host
+ * @param scale Size of the templates, 1 is the smallest
+ * @param depth Levels of the nested template
+ * @return std::vector<BenchmarkCase> The cases
+ */
+static std::vector<BenchmarkCase> generateCorpus(
+    const std::string &root,
+    size_t scale,
+    size_t depth
+) {
+    std::vector<BenchmarkCase> cases;
+
+    // Many siblings with attributes and text
+    std::ostringstream flat;
+    flat << "doctype html\nhtml\n  head\n    title Flat\n  body\n    ul\n";
+    for (size_t i = 0; i < 100 * scale; i++) {
+        flat << "      li.item(id=\"item" << i << "\" title=\"Item " << i
+             << "\") Item " << i << " of the list\n";
+    }
+    cases.push_back({"flat", "/flat.pug", 0, 0});
+    writeFile(root, cases.back().path, flat.str());
+
+    // Deep nesting, every level is closed again
+    std::ostringstream nested;
+    nested << "doctype html\nhtml\n  body\n";
+    for (size_t block = 0; block < 4 * scale; block++) {
+        std::string indentation = "    ";
+        for (size_t level = 0; level < depth; level++) {
+            nested << indentation << "div.level" << level << "\n";
+            indentation += "  ";
+        }
+        nested << indentation << "span deepest #{IO_ROTATE}\n";
+    }
+    cases.push_back({"nested", "/nested.pug", 0, 0});
+    writeFile(root, cases.back().path, nested.str());
+
+    // Includes of pug files, nested pug files and plain files
+    writeFile(root, "/partials/style.css", "body { margin: 0; }\n");
+    writeFile(
+        root,
+        "/partials/leaf.pug",
+        "span.leaf Temperature #{IO_TEMP}\n"
+    );
+    for (size_t part = 0; part < 8; part++) {
+        std::ostringstream partial;
+        partial << "section.part" << part << "\n"
+                << "  h2 Part " << part << "\n"
+                << "  p Some text of the part\n"
+                << "  include leaf.pug\n";
+        writeFile(
+            root,
+            "/partials/part" + std::to_string(part) + ".pug",
+            partial.str()
+        );
+    }
+    std::ostringstream includes;
+    includes << "doctype html\nhtml\n  head\n    style\n"
+             << "      include partials/style.css\n  body\n";
+    for (size_t i = 0; i < 10 * scale; i++) {
+        includes << "    include /partials/part" << i % 8 << ".pug\n";
+    }
+    cases.push_back({"includes", "/includes.pug", 0, 0});
+    writeFile(root, cases.back().path, includes.str());
+
+    // Plain includes from 1 KB to 1 MB, copied into the page as they are
+    for (size_t size : {1 << 10, 32 << 10, 1 << 20}) {
+        std::string name = size < (1 << 20)
+                               ? std::to_string(size >> 10) + "k"
+                               : std::to_string(size >> 20) + "m";
+        std::string style;
+        for (size_t rule = 0; style.size() < size; rule++) {
+            style += ".rule" + std::to_string(rule) + " { margin: 0; }\n";
+        }
+        style.resize(size - 1);
+        style += "\n";
+        writeFile(root, "/partials/plain-" + name + ".css", style);
+
+        cases.push_back({"plain-" + name, "/plain-" + name + ".pug", 0, 0});
+        writeFile(
+            root,
+            cases.back().path,
+            "doctype html\nhtml\n  head\n    style\n"
+            "      include partials/plain-" + name + ".css\n"
+            "  body\n    p Styled\n"
+        );
+    }
+
+    // Chains of conditionals on the GPIOs
+    std::ostringstream conditionals;
+    conditionals << "doctype html\nhtml\n  body\n";
+    for (size_t i = 0; i < 25 * scale; i++) {
+        conditionals << "    if IO_BUTTON:\n"
+                     << "      p Pressed " << i << "\n"
+                     << "    else if (IO_ROTATE = " << i % 16 << "):\n"
+                     << "      p Rotated to " << i % 16 << "\n"
+                     << "    else unless IO_LED:\n"
+                     << "      p.off LED off\n"
+                     << "    else:\n"
+                     << "      p Analog #{IO_ANALOG}\n";
+    }
+    cases.push_back({"conditionals", "/conditionals.pug", 0, 0});
+    writeFile(root, cases.back().path, conditionals.str());
+
+    // Long text in all its forms
+    std::ostringstream text;
+    text << "doctype html\nhtml\n  body\n";
+    for (size_t i = 0; i < 25 * scale; i++) {
+        text << "    p Paragraph " << i
+             << " with #[b bold] and #[i italic] text and a value of "
+                "#{IO_HUMIDITY}\n"
+             << "    p.\n"
+             << "      Block text that goes on for a while, as text in a\n"
+             << "      page usually does, without any markup in it.\n"
+             << "    div\n"
+             << "      | Piped text on its own line\n"
+             << "      | and another one <em>with literal HTML</em>\n"
+             << "    // A comment that is kept in the output\n";
+    }
+    cases.push_back({"text", "/text.pug", 0, 0});
+    writeFile(root, cases.back().path, text.str());
+
+    for (BenchmarkCase &benchmarkCase : cases) {
+        measure(root, benchmarkCase.path, benchmarkCase.lines,
+                benchmarkCase.bytes);
+    }
+
+    return cases;
+}
+
+/**
+ * @brief Run a case
+ *
+ * @param benchmarkCase The case
+ * @param runs Amount of runs
+ * @param compile Wether the program is compiled on every run,
+ *                otherwise only the first run compiles it and isn't measured
+ * @param result Gets the result
+ * @return bool Wether every run was successful
+ */
+static bool run(
+    const BenchmarkCase &benchmarkCase,
+    size_t runs,
+    bool compile,
+    BenchmarkResult &result
+) {
+    String path = String(benchmarkCase.path.c_str());
+    String programPath = path + ".prg";
+
+    result = BenchmarkResult();
+    result.runs = runs;
+
+    // Warm up, compiles the program
+    LittleFS.remove(programPath);
+    NullOutput warmUp = NullOutput();
+    if (!aalec_pug(path, warmUp)) {
+        return false;
+    }
+    result.outputBytes = warmUp.bytes;
+
+    for (size_t i = 0; i < runs; i++) {
+        if (compile) {
+            LittleFS.remove(programPath);
+        }
+
+        NullOutput out = NullOutput();
+        uint64_t allocations = heap.allocations;
+        size_t live = heap.live;
+        heap.peak = heap.live;
+
+        auto start = std::chrono::steady_clock::now();
+        bool success = aalec_pug(path, out);
+        auto end = std::chrono::steady_clock::now();
+
+        result.seconds += std::chrono::duration<double>(end - start).count();
+        result.allocations += heap.allocations - allocations;
+        result.peakHeap = std::max(result.peakHeap, heap.peak - live);
+
+        if (!success || out.bytes != result.outputBytes) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parse the command line
+ *
+ * @param argc Amount of arguments
+ * @param argv The arguments
+ * @param options Gets the options
+ * @return bool Wether the arguments are valid
+ */
+static bool parseOptions(int argc, char **argv, BenchmarkOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--iterations") {
+            options.iterations = std::stoul(value);
+        } else if (option == "--scale") {
+            options.scale = std::stoul(value);
+        } else if (option == "--depth") {
+            options.depth = std::stoul(value);
+        } else if (option == "--case") {
+            options.only = value;
+        } else if (option == "--root") {
+            options.root = value;
+        } else if (option == "--dht-latency") {
+            options.dhtLatencyUs = std::stoul(value);
+        } else {
+            return false;
+        }
+    }
+
+    return options.iterations > 0 && options.scale > 0 && options.depth > 0;
+}
+
+int main(int argc, char **argv) {
+    BenchmarkOptions options = BenchmarkOptions();
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(
+            stderr,
+            "Usage: %s [--iterations N] [--scale N] [--depth N] "
+            "[--case NAME] [--root DIR] [--dht-latency US]\n",
+            argv[0]
+        );
+        return 2;
+    }
+
+    // The corpus is generated into a fresh directory
+    bool temporary = options.root.empty();
+    if (temporary) {
+        options.root = temporaryRoot("benchmark");
+    }
+    std::filesystem::create_directories(options.root);
+    LittleFS.setRoot(options.root);
+
+    // Fixed sensor values, so every run renders the same page
+    aalec.led = 1;
+    aalec.button = 0;
+    aalec.rotate = 3;
+    aalec.temp = 21.5f;
+    aalec.humidity = 40.0f;
+    aalec.analog = 512;
+    aalec.dhtLatencyUs = options.dhtLatencyUs;
+
+    std::vector<BenchmarkCase> cases = generateCorpus(
+        options.root,
+        options.scale,
+        options.depth
+    );
+
+    printf(
+        "%-13s %-8s %-11s %6s %8s %12s %12s %10s %11s %10s\n",
+        "case",
+        "mode",
+        "program",
+        "runs",
+        "lines",
+        "lines/s",
+        "bytes/s",
+        "out bytes",
+        "allocs/run",
+        "peak heap"
+    );
+
+    bool success = true;
+    for (const BenchmarkCase &benchmarkCase : cases) {
+        if (!options.only.empty() && benchmarkCase.name != options.only) {
+            continue;
+        }
+
+        for (bool compile : {true, false}) {
+            BenchmarkResult result = BenchmarkResult();
+            if (!run(benchmarkCase, options.iterations, compile, result)) {
+                fprintf(
+                    stderr,
+                    "Error: '%s' failed\n",
+                    benchmarkCase.name.c_str()
+                );
+                success = false;
+                break;
+            }
+
+            // Sources that can't be compiled depend on every GPIO
+            u16 gpios = 0;
+            aalec_pug_gpios(String(benchmarkCase.path.c_str()), gpios);
+
+            double seconds = result.seconds > 0 ? result.seconds : 1e-9;
+            printf(
+                "%-13s %-8s %-11s %6zu %8zu %12.0f %12.0f %10zu %11.1f %10zu\n",
+                benchmarkCase.name.c_str(),
+                compile ? "compile" : "render",
+                gpios == 0xFFFF ? "interpreted" : "compiled",
+                result.runs,
+                benchmarkCase.lines,
+                benchmarkCase.lines * result.runs / seconds,
+                benchmarkCase.bytes * result.runs / seconds,
+                result.outputBytes,
+                (double)result.allocations / result.runs,
+                result.peakHeap
+            );
+        }
+    }
+
+    if (temporary) {
+        std::filesystem::remove_all(options.root);
+    }
+
+    return success ? 0 : 1;
+}
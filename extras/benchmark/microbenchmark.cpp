@@ -0,0 +1,655 @@
+/**
+ * Microbenchmarks of the Scanner and the Parser on the host.
+ * Times single functions on generated input, with a growing amount of the
+ * construct they handle (attributes, lines, branches, GPIO values),
+ * and writes the results as a table, JSON or CSV.
+ *
+ * Usage: aalec_pug_microbenchmark [--format table|json|csv] [--filter TEXT]
+ *                                 [--min-time MS] [--repetitions N]
+ *                                 [--root DIR]
+ */
+#include <AALeC-V2.h>
+#include <LittleFS.h>
+#include <parser/parser.h>
+
+#include "support.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Result of one function with one amount of its construct
+ */
+class MicroBenchmarkResult {
+   public:
+    /**
+     * @brief Name of the benchmark, eg: "scanner/scanTagAttributes"
+     */
+    std::string name;
+
+    /**
+     * @brief Amount of the construct, eg: the attributes of the tag
+     */
+    size_t n;
+
+    /**
+     * @brief Bytes of one call, read by the Scanner or written by the Parser
+     */
+    size_t bytes;
+
+    /**
+     * @brief Calls of each repetition
+     */
+    uint64_t iterations;
+
+    /**
+     * @brief Median time of a call over the repetitions in nanoseconds
+     */
+    double nsPerOp;
+
+    /**
+     * @brief Heap allocations of a call
+     */
+    double allocationsPerOp;
+};
+
+/**
+ * @brief Options of the command line
+ */
+class MicroBenchmarkOptions {
+   public:
+    std::string format = "table";
+    std::string filter;
+    double minTimeMs = 20;
+    size_t repetitions = 5;
+    std::string root;
+};
+
+/**
+ * @brief The benchmarks, a friend of the Scanner and the Parser
+ */
+class MicroBenchmark {
+   private:
+    /**
+     * @brief The options
+     */
+    const MicroBenchmarkOptions &options_;
+
+    /**
+     * @brief The GPIO values of all benchmarks
+     */
+    GPIOSnapshot gpios_;
+
+    /**
+     * @brief Amount of generated sources, gives each one its own file
+     */
+    size_t sources_;
+
+    /**
+     * @brief The results so far
+     */
+    std::vector<MicroBenchmarkResult> results_;
+
+   public:
+    /**
+     * @brief Construct a new MicroBenchmark object
+     *
+     * @param options The options
+     */
+    MicroBenchmark(const MicroBenchmarkOptions &options);
+
+    /**
+     * @brief Run the benchmarks of the Scanner
+     *
+     * @return bool Wether every call was successful
+     */
+    bool runScanner();
+
+    /**
+     * @brief Run the benchmarks of the Parser
+     *
+     * @return bool Wether every call was successful
+     */
+    bool runParser();
+
+    /**
+     * @brief The results of all benchmarks that ran
+     *
+     * @return const std::vector<MicroBenchmarkResult>& The results
+     */
+    const std::vector<MicroBenchmarkResult> &results() const;
+
+   private:
+    /**
+     * @brief Write a generated source to the file system
+     *
+     * @param content The source
+     * @return String Path of the source in the file system
+     */
+    String source(const std::string &content);
+
+    /**
+     * @brief Time a call and add its result, skipped if it doesn't match
+     *        the filter
+     *
+     * @param name Name of the benchmark
+     * @param n Amount of the construct
+     * @param bytes Bytes of one call
+     * @param operation The call, returns wether it was successful
+     * @return bool Wether every call was successful
+     */
+    template <typename Operation>
+    bool measure(
+        const std::string &name,
+        size_t n,
+        size_t bytes,
+        Operation operation
+    );
+};
+
+/**
+ * @brief A line with GPIO values that cycles through the keys
+ *
+ * @param n Amount of GPIO values
+ * @return std::string The line without the '\n'
+ */
+static std::string interpolatedText(size_t n) {
+    static const char *keys[] = {
+        "IO_LED",
+        "IO_BUTTON",
+        "IO_ROTATE",
+        "IO_TEMP",
+        "IO_HUMIDITY",
+        "IO_ANALOG",
+    };
+
+    std::string text = "Values";
+    for (size_t i = 0; i < n; i++) {
+        text += std::string(" and #{") + keys[i % 6] + "}";
+    }
+
+    return text;
+}
+
+/**
+ * @brief Attributes with quoted values
+ *
+ * @param n Amount of attributes
+ * @return std::string The attributes in parentheses
+ */
+static std::string attributes(size_t n) {
+    std::string text = "(";
+    for (size_t i = 0; i < n; i++) {
+        text += (i > 0 ? " data" : "data") + std::to_string(i) + "=\"value "
+            + std::to_string(i) + "\"";
+    }
+
+    return text + ")";
+}
+
+MicroBenchmark::MicroBenchmark(const MicroBenchmarkOptions &options) :
+    options_(options),
+    gpios_(GPIOSnapshot()),
+    sources_(0),
+    results_() {}
+
+bool MicroBenchmark::runScanner() {
+    ArenaScope arena = ArenaScope();
+    bool success = true;
+
+    // Restoring the position, part of every other scanner benchmark
+    {
+        Scanner scanner = Scanner(source("p\n"), gpios_);
+        ScannerState start = scanner.state();
+        success &= measure("scanner/restore", 0, 0, [&]() {
+            scanner.restore(start);
+            return true;
+        });
+    }
+
+    // Comparing the next characters
+    {
+        Scanner scanner = Scanner(source("doctype html\n"), gpios_);
+        scanner.restore(scanner.state());
+        success &= measure("scanner/check(char)", 1, 1, [&]() {
+            return scanner.check('d');
+        });
+        success &= measure("scanner/check(PGM_P)", 7, 7, [&]() {
+            return scanner.check(PSTR("doctype"));
+        });
+    }
+
+    // Consuming characters one by one into a value
+    for (size_t n : {16, 256}) {
+        Scanner scanner = Scanner(source(std::string(n, 'a') + "\n"), gpios_);
+        ScannerState start = scanner.state();
+        success &= measure("scanner/consume", n, n, [&]() {
+            scanner.restore(start);
+            SourceString value = SourceString();
+            for (size_t i = 0; i < n; i++) {
+                scanner.consume(value);
+            }
+            return value.length() == n;
+        });
+    }
+
+    // Skipping indentation
+    for (size_t n : {1, 16, 64}) {
+        Scanner scanner = Scanner(source(std::string(n, ' ') + "p\n"), gpios_);
+        ScannerState start = scanner.state();
+        success &= measure("scanner/ignoreWhitespaces", n, n, [&]() {
+            scanner.restore(start);
+            scanner.ignoreWhitespaces();
+            return scanner.check('p');
+        });
+    }
+
+    // Attributes in parentheses
+    for (size_t n : {1, 4, 16}) {
+        std::string content = attributes(n);
+        Scanner scanner = Scanner(source(content + "\n"), gpios_);
+        ScannerState start = scanner.state();
+        success &= measure(
+            "scanner/scanTagAttributes",
+            n,
+            content.size(),
+            [&]() {
+                scanner.restore(start);
+                ArenaVector<Attribute> attributes = ArenaVector<Attribute>();
+                return scanner.scanTagAttributes(attributes)
+                    && attributes.size() == n;
+            }
+        );
+    }
+
+    // Block text after "p."
+    for (size_t n : {1, 8, 32}) {
+        std::string content = "p.\n";
+        for (size_t i = 0; i < n; i++) {
+            content += "  Line of the block text in a paragraph\n";
+        }
+        Scanner scanner = Scanner(source(content), gpios_);
+        ScannerState start = scanner.state();
+        start.position = 2;
+        success &= measure(
+            "scanner/scanTagTextBlock",
+            n,
+            content.size() - 2,
+            [&]() {
+                scanner.restore(start);
+                SourceString value = SourceString();
+                return scanner.scanTagTextBlock(value) && !value.isEmpty();
+            }
+        );
+    }
+
+    // Conditionals that are decided by their last branch
+    for (size_t n : {0, 1, 4, 16}) {
+        std::string content = "if IO_BUTTON:\n  p Pressed\n";
+        for (size_t i = 0; i < n; i++) {
+            content += "else if (IO_ROTATE = 99):\n  p Rotated\n";
+        }
+        content += "else:\n  p Neither\n";
+        Scanner scanner = Scanner(source(content), gpios_);
+        ScannerState start = scanner.state();
+        success &= measure(
+            "scanner/scanConditional",
+            n,
+            content.rfind("\n  p Neither"),
+            [&]() {
+                scanner.restore(start);
+                return scanner.scanConditional()
+                    && scanner.check(PSTR("\n  p Neither"));
+            }
+        );
+    }
+
+    // GPIO values in a text
+    for (size_t n : {1, 4, 16}) {
+        std::string content = interpolatedText(n);
+        Scanner scanner = Scanner(source(content + "\n"), gpios_);
+        ScannerState start = scanner.state();
+        success &= measure(
+            "scanner/interpolation",
+            n,
+            content.size(),
+            [&]() {
+                scanner.restore(start);
+                SourceString value = SourceString();
+                bool scanned = scanner.scanTagTextInline(value)
+                    && scanner.interpolations_.size() == n;
+                scanner.interpolations_.clear();
+                return scanned;
+            }
+        );
+    }
+
+    return success;
+}
+
+bool MicroBenchmark::runParser() {
+    ArenaScope arena = ArenaScope();
+    bool success = true;
+    NullOutput out = NullOutput();
+
+    // Tags with attributes and text, each one is closed again
+    for (size_t n : {0, 1, 4, 16}) {
+        Parser parser = Parser(
+            source("div" + attributes(n) + " Text of the tag\n"),
+            out,
+            gpios_
+        );
+        parser.scanner_.restore(parser.scanner_.state());
+        TagData data = TagData();
+        if (!parser.scanner_.scanTag(data)) {
+            return false;
+        }
+
+        size_t bytes = out.bytes;
+        parser.parseTag(data);
+        parser.closeTag();
+        success &= measure("parser/parseTag", n, out.bytes - bytes, [&]() {
+            parser.parseTag(data);
+            parser.closeTag();
+            return true;
+        });
+    }
+
+    // Piped text with GPIO values
+    for (size_t n : {0, 1, 4, 16}) {
+        Parser parser = Parser(
+            source("| " + interpolatedText(n) + "\n"),
+            out,
+            gpios_
+        );
+        parser.scanner_.restore(parser.scanner_.state());
+        TextData data = TextData();
+        if (!parser.scanner_.scanText(data)) {
+            return false;
+        }
+
+        size_t bytes = out.bytes;
+        parser.parseText(data);
+        parser.closeTag();
+        success &= measure("parser/parseText", n, out.bytes - bytes, [&]() {
+            parser.parseText(data);
+            parser.closeTag();
+            return true;
+        });
+    }
+
+    // Comments that are kept in the output
+    {
+        Parser parser = Parser(
+            source("// A comment that is kept in the output\n"),
+            out,
+            gpios_
+        );
+        parser.scanner_.restore(parser.scanner_.state());
+        CommentData data = CommentData();
+        if (!parser.scanner_.scanComment(data)) {
+            return false;
+        }
+
+        size_t bytes = out.bytes;
+        parser.parseComment(data);
+        parser.closeTag();
+        success &= measure("parser/parseComment", 1, out.bytes - bytes, [&]() {
+            parser.parseComment(data);
+            parser.closeTag();
+            return true;
+        });
+    }
+
+    // The doctype, set again on every call
+    {
+        Parser parser = Parser(source("doctype html\n"), out, gpios_);
+        parser.scanner_.restore(parser.scanner_.state());
+        DoctypeData data = DoctypeData();
+        if (!parser.scanner_.scanDoctype(data)) {
+            return false;
+        }
+
+        size_t bytes = out.bytes;
+        parser.parseDoctype(data);
+        parser.closeTag();
+        success &= measure("parser/parseDoctype", 1, out.bytes - bytes, [&]() {
+            parser.doctype_ = DoctypeDialect::None;
+            parser.parseDoctype(data);
+            parser.closeTag();
+            return true;
+        });
+    }
+
+    return success;
+}
+
+const std::vector<MicroBenchmarkResult> &MicroBenchmark::results() const {
+    return results_;
+}
+
+String MicroBenchmark::source(const std::string &content) {
+    std::string path = "/source" + std::to_string(sources_++) + ".pug";
+    writeFile(options_.root, path, content);
+    return String(path.c_str());
+}
+
+template <typename Operation>
+bool MicroBenchmark::measure(
+    const std::string &name,
+    size_t n,
+    size_t bytes,
+    Operation operation
+) {
+    if (!options_.filter.empty()
+        && name.find(options_.filter) == std::string::npos) {
+        return true;
+    }
+
+    // Time a batch of calls in seconds
+    bool success = true;
+    auto time = [&](uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            success &= operation();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    // Grow the batch until it takes the minimum time, also warms up
+    uint64_t iterations = 1;
+    while (time(iterations) * 1000 < options_.minTimeMs
+           && iterations < (1ull << 32)) {
+        iterations *= 2;
+    }
+
+    // Median of the repetitions
+    std::vector<double> nsPerOp;
+    uint64_t allocations = heap.allocations;
+    for (size_t i = 0; i < options_.repetitions; i++) {
+        nsPerOp.push_back(time(iterations) * 1e9 / iterations);
+    }
+    allocations = heap.allocations - allocations;
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    if (!success) {
+        fprintf(stderr, "Error: '%s' (n=%zu) failed\n", name.c_str(), n);
+        return false;
+    }
+
+    MicroBenchmarkResult result = MicroBenchmarkResult();
+    result.name = name;
+    result.n = n;
+    result.bytes = bytes;
+    result.iterations = iterations;
+    result.nsPerOp = nsPerOp[nsPerOp.size() / 2];
+    result.allocationsPerOp = (double)allocations
+        / (iterations * options_.repetitions);
+    results_.push_back(result);
+
+    return true;
+}
+
+/**
+ * @brief Bytes per second of a result
+ *
+ * @param result The result
+ * @return double The bytes per second, 0 if the call has no bytes
+ */
+static double bytesPerSecond(const MicroBenchmarkResult &result) {
+    return result.nsPerOp > 0 ? result.bytes * 1e9 / result.nsPerOp : 0;
+}
+
+/**
+ * @brief Write the results to stdout
+ *
+ * @param results The results
+ * @param format "table", "json" or "csv"
+ */
+static void printResults(
+    const std::vector<MicroBenchmarkResult> &results,
+    const std::string &format
+) {
+    if (format == "json") {
+        printf("{\n  \"unit\": \"ns\",\n  \"benchmarks\": [");
+        for (size_t i = 0; i < results.size(); i++) {
+            const MicroBenchmarkResult &result = results[i];
+            printf(
+                "%s\n    {\"name\": \"%s\", \"n\": %zu, \"bytes\": %zu, "
+                "\"iterations\": %llu, \"ns_per_op\": %.2f, "
+                "\"bytes_per_s\": %.0f, \"allocs_per_op\": %.3f}",
+                i > 0 ? "," : "",
+                result.name.c_str(),
+                result.n,
+                result.bytes,
+                (unsigned long long)result.iterations,
+                result.nsPerOp,
+                bytesPerSecond(result),
+                result.allocationsPerOp
+            );
+        }
+        printf("\n  ]\n}\n");
+    } else if (format == "csv") {
+        printf("name,n,bytes,iterations,ns_per_op,bytes_per_s,allocs_per_op\n");
+        for (const MicroBenchmarkResult &result : results) {
+            printf(
+                "%s,%zu,%zu,%llu,%.2f,%.0f,%.3f\n",
+                result.name.c_str(),
+                result.n,
+                result.bytes,
+                (unsigned long long)result.iterations,
+                result.nsPerOp,
+                bytesPerSecond(result),
+                result.allocationsPerOp
+            );
+        }
+    } else {
+        printf(
+            "%-26s %4s %6s %11s %10s %13s %10s\n",
+            "benchmark",
+            "n",
+            "bytes",
+            "iterations",
+            "ns/op",
+            "bytes/s",
+            "allocs/op"
+        );
+        for (const MicroBenchmarkResult &result : results) {
+            printf(
+                "%-26s %4zu %6zu %11llu %10.1f %13.0f %10.3f\n",
+                result.name.c_str(),
+                result.n,
+                result.bytes,
+                (unsigned long long)result.iterations,
+                result.nsPerOp,
+                bytesPerSecond(result),
+                result.allocationsPerOp
+            );
+        }
+    }
+}
+
+/**
+ * @brief Parse the command line
+ *
+ * @param argc Amount of arguments
+ * @param argv The arguments
+ * @param options Gets the options
+ * @return bool Wether the arguments are valid
+ */
+static bool parseOptions(
+    int argc,
+    char **argv,
+    MicroBenchmarkOptions &options
+) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--format") {
+            options.format = value;
+        } else if (option == "--filter") {
+            options.filter = value;
+        } else if (option == "--min-time") {
+            options.minTimeMs = std::stod(value);
+        } else if (option == "--repetitions") {
+            options.repetitions = std::stoul(value);
+        } else if (option == "--root") {
+            options.root = value;
+        } else {
+            return false;
+        }
+    }
+
+    return (options.format == "table" || options.format == "json"
+            || options.format == "csv")
+        && options.repetitions > 0;
+}
+
+int main(int argc, char **argv) {
+    MicroBenchmarkOptions options = MicroBenchmarkOptions();
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(
+            stderr,
+            "Usage: %s [--format table|json|csv] [--filter TEXT] "
+            "[--min-time MS] [--repetitions N] [--root DIR]\n",
+            argv[0]
+        );
+        return 2;
+    }
+
+    // The sources are generated into a fresh directory
+    bool temporary = options.root.empty();
+    if (temporary) {
+        options.root = temporaryRoot("microbenchmark");
+    }
+    std::filesystem::create_directories(options.root);
+    LittleFS.setRoot(options.root);
+
+    // Fixed sensor values, the conditionals go through every branch
+    aalec.led = 1;
+    aalec.button = 0;
+    aalec.rotate = 3;
+    aalec.temp = 21.5f;
+    aalec.humidity = 40.0f;
+    aalec.analog = 512;
+
+    MicroBenchmark benchmark = MicroBenchmark(options);
+    bool success = benchmark.runScanner();
+    success &= benchmark.runParser();
+
+    printResults(benchmark.results(), options.format);
+
+    if (temporary) {
+        std::filesystem::remove_all(options.root);
+    }
+
+    return success ? 0 : 1;
+}
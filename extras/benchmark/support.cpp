@@ -0,0 +1,93 @@
+#include "support.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+HeapStats heap = HeapStats();
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+
+/**
+ * @brief Count an allocation
+ *
+ * @param pointer The allocated memory, nullptr if it failed
+ */
+static void allocated(void *pointer) {
+    if (pointer != nullptr) {
+        heap.allocations++;
+        heap.live += malloc_usable_size(pointer);
+        heap.peak = std::max(heap.peak, heap.live);
+    }
+}
+
+/**
+ * @brief Count a release
+ *
+ * @param pointer The released memory, nullptr is ignored
+ */
+static void released(void *pointer) {
+    if (pointer != nullptr) {
+        heap.live -= malloc_usable_size(pointer);
+    }
+}
+
+void *malloc(size_t size) {
+    void *pointer = __libc_malloc(size);
+    allocated(pointer);
+    return pointer;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *pointer = __libc_calloc(count, size);
+    allocated(pointer);
+    return pointer;
+}
+
+void *realloc(void *pointer, size_t size) {
+    released(pointer);
+    void *moved = __libc_realloc(pointer, size);
+    allocated(moved != nullptr ? moved : (size > 0 ? pointer : nullptr));
+    return moved;
+}
+
+void free(void *pointer) {
+    released(pointer);
+    __libc_free(pointer);
+}
+}
+#endif
+
+void writeFile(
+    const std::string &root,
+    const std::string &path,
+    const std::string &content
+) {
+    std::filesystem::path hostPath = std::filesystem::path(root + path);
+    std::filesystem::create_directories(hostPath.parent_path());
+    std::ofstream file = std::ofstream(hostPath, std::ios::binary);
+    file << content;
+    file.close();
+
+    // Programs are compiled again if a source is as new as the program
+    std::filesystem::last_write_time(
+        hostPath,
+        std::filesystem::file_time_type::clock::now() - std::chrono::hours(1)
+    );
+}
+
+std::string temporaryRoot(const std::string &name) {
+    return (std::filesystem::temp_directory_path()
+            / ("aalec-pug-" + name + "-" + std::to_string(getpid())))
+        .string();
+}
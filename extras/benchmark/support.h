@@ -0,0 +1,84 @@
+/**
+ * Shared parts of the host benchmarks: counting allocations,
+ * an output that discards the HTML and writing generated templates.
+ */
+#ifndef BENCHMARK_SUPPORT_H
+#define BENCHMARK_SUPPORT_H
+
+#include <Arduino.h>
+
+#include <string>
+
+/**
+ * @brief Allocations of the process, counted by malloc wrappers with glibc,
+ *        everything stays 0 otherwise
+ */
+class HeapStats {
+   public:
+    /**
+     * @brief Amount of allocations
+     */
+    uint64_t allocations;
+
+    /**
+     * @brief Bytes that are allocated right now
+     */
+    size_t live;
+
+    /**
+     * @brief Most bytes that were allocated at once since the last reset
+     */
+    size_t peak;
+};
+
+/**
+ * @brief The allocations of the process
+ */
+extern HeapStats heap;
+
+/**
+ * @brief Output that only counts the bytes, so writing costs nothing
+ */
+class NullOutput : public Print {
+   public:
+    /**
+     * @brief Amount of written bytes
+     */
+    size_t bytes = 0;
+
+    size_t write(uint8_t value) override {
+        (void)value;
+        bytes++;
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        (void)buffer;
+        bytes += size;
+        return size;
+    }
+};
+
+/**
+ * @brief Write a generated file, dated back so programs compiled from it
+ *        aren't seen as outdated
+ *
+ * @param root The file system root on the host
+ * @param path Path in the file system
+ * @param content The content
+ */
+void writeFile(
+    const std::string &root,
+    const std::string &path,
+    const std::string &content
+);
+
+/**
+ * @brief A fresh directory for the file system of a benchmark
+ *
+ * @param name Name of the benchmark, eg: "benchmark"
+ * @return std::string The path on the host
+ */
+std::string temporaryRoot(const std::string &name);
+
+#endif  // BENCHMARK_SUPPORT_H
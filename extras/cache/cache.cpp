@@ -0,0 +1,227 @@
+/**
+ * Checks of the output cache on the host: the rounding of values with
+ * hysteresis, which renders are answered by the cache, the order pages are
+ * removed in when the budget is exceeded and the limit of the copies.
+ *
+ * Usage: aalec_pug_cache [--root DIR]
+ */
+#include <AALeC-V2.h>
+#include <AALeC-pug.h>
+#include <LittleFS.h>
+#include <StreamString.h>
+
+#include "../benchmark/support.h"
+
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief Amount of failed checks
+ */
+static size_t failures = 0;
+
+/**
+ * @brief Report a check that failed
+ *
+ * @param passed Wether the check passed
+ * @param what What was checked
+ */
+static void check(bool passed, const std::string &what) {
+    if (!passed) {
+        fprintf(stderr, "Error: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+/**
+ * @brief Render a page through the cache
+ *
+ * @param path Path to the pug file
+ * @return std::string The HTML
+ */
+static std::string render(const char *path) {
+    StreamString out;
+    GPIOSnapshot gpios = GPIOSnapshot();
+    check(aalec_pug(String(path), out, gpios), std::string(path) + " failed");
+
+    return out.c_str();
+}
+
+/**
+ * @brief Render a page and check wether the cache answered it
+ *
+ * @param path Path to the pug file
+ * @param hit Wether the page should come from the cache
+ * @param html The expected HTML
+ * @param what Name of the check
+ */
+static void expect(
+    const char *path,
+    bool hit,
+    const std::string &html,
+    const std::string &what
+) {
+    uint32_t hits = outputCache.hits();
+    uint32_t misses = outputCache.misses();
+    std::string rendered = render(path);
+
+    check(
+        outputCache.hits() == hits + (hit ? 1 : 0)
+            && outputCache.misses() == misses + (hit ? 0 : 1),
+        what + ": expected a " + (hit ? "hit" : "miss")
+    );
+    check(
+        rendered == html,
+        what + ": rendered '" + rendered + "' instead of '" + html + "'"
+    );
+}
+
+/**
+ * @brief Round values with and without hysteresis
+ */
+static void checkQuantization() {
+    Quantization exact = Quantization();
+    check(exact.apply(17) == 17, "Step 0 changed the value");
+
+    Quantization quantization = Quantization();
+    quantization.step = 10;
+    quantization.hysteresis = 2;
+    struct {
+        u32 value;
+        u32 step;
+    } steps[] = {
+        {15, 1},  // First value
+        {21, 1},  // Within the hysteresis above 10 to 19
+        {22, 2},  // Beyond it
+        {18, 2},  // Within the hysteresis below 20 to 29
+        {17, 1},  // Beyond it
+        {5, 0},   // More than a step away
+    };
+    for (const auto &step : steps) {
+        u32 rounded = quantization.apply(step.value);
+        check(
+            rounded == step.step,
+            "Rounded " + std::to_string(step.value) + " to step "
+                + std::to_string(rounded) + " instead of "
+                + std::to_string(step.step)
+        );
+    }
+}
+
+/**
+ * @brief Hits and misses of a page that shows a rounded value
+ */
+static void checkHits() {
+    outputCache.setBudget(1 << 16);
+    outputCache.setQuantization(GPIOId::Temp, 10, 2);
+
+    aalec.temp = 21;
+    expect("/temp.pug", false, "<p>21</p>", "First render");
+    aalec.temp = 28;
+    expect("/temp.pug", true, "<p>21</p>", "Same step");
+    aalec.temp = 31;
+    expect("/temp.pug", true, "<p>21</p>", "Within the hysteresis");
+    aalec.temp = 32;
+    expect("/temp.pug", false, "<p>32</p>", "Next step");
+    aalec.temp = 29;
+    expect("/temp.pug", true, "<p>32</p>", "Back within the hysteresis");
+    aalec.temp = 21;
+    expect("/temp.pug", true, "<p>21</p>", "Back to the first step");
+
+    outputCache.setQuantization(GPIOId::Temp, 0);
+    outputCache.setBudget(0);
+}
+
+/**
+ * @brief The least recently used pages are removed first
+ */
+static void checkEviction() {
+    // Exactly two of the pages fit
+    outputCache.setBudget(1 << 16);
+    render("/a.pug");
+    render("/b.pug");
+    size_t two = outputCache.size();
+    outputCache.setBudget(two);
+
+    expect("/a.pug", true, "<p>a</p>", "Cached a");
+    expect("/c.pug", false, "<p>c</p>", "New c");
+    check(outputCache.size() == two, "The budget was exceeded");
+    expect("/a.pug", true, "<p>a</p>", "a after c");
+    expect("/b.pug", false, "<p>b</p>", "b after c");
+
+    // Shrinking the budget keeps the most recently used page
+    outputCache.setBudget(two - 1);
+    check(outputCache.size() == two / 2, "Shrinking kept two pages");
+    expect("/b.pug", true, "<p>b</p>", "b after shrinking");
+    expect("/a.pug", false, "<p>a</p>", "a after shrinking");
+
+    outputCache.setBudget(0);
+    check(outputCache.size() == 0, "Disabling kept pages");
+}
+
+/**
+ * @brief Copies stop at their limit, pages beyond the budget aren't kept
+ */
+static void checkLimit() {
+    NullOutput out = NullOutput();
+    std::vector<uint8_t> copy;
+    CacheOutput cacheOutput = CacheOutput(out, copy, 100);
+    uint8_t bytes[60] = {};
+
+    cacheOutput.write(bytes, 60);
+    cacheOutput.write(bytes, 30);
+    check(!cacheOutput.overflowed(), "90 bytes overflowed 100");
+    check(copy.size() == 90, "The copy is incomplete");
+    check(copy.capacity() <= 100, "The copy grew beyond its limit");
+
+    cacheOutput.write(bytes, 11);
+    check(cacheOutput.overflowed(), "101 bytes didn't overflow 100");
+    check(copy.capacity() == 0, "The copy was kept");
+    check(out.bytes == 101, "The output is incomplete");
+
+    // The page is still written, just not kept
+    outputCache.setBudget(sizeof(CacheEntry));
+    expect("/a.pug", false, "<p>a</p>", "Page beyond the budget");
+    expect("/a.pug", false, "<p>a</p>", "Page beyond the budget again");
+    check(outputCache.size() == 0, "A page beyond the budget was kept");
+    outputCache.setBudget(0);
+}
+
+int main(int argc, char **argv) {
+    std::string root;
+    if (argc == 3 && std::string(argv[1]) == "--root") {
+        root = argv[2];
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [--root DIR]\n", argv[0]);
+        return 2;
+    }
+
+    bool temporary = root.empty();
+    if (temporary) {
+        root = temporaryRoot("cache");
+    }
+    std::filesystem::create_directories(root);
+    LittleFS.setRoot(root);
+
+    writeFile(root, "/temp.pug", "p #{IO_TEMP}\n");
+    writeFile(root, "/a.pug", "p a\n");
+    writeFile(root, "/b.pug", "p b\n");
+    writeFile(root, "/c.pug", "p c\n");
+
+    checkQuantization();
+    checkHits();
+    checkEviction();
+    checkLimit();
+
+    if (temporary) {
+        std::filesystem::remove_all(root);
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "%zu checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks of the output cache passed\n");
+
+    return 0;
+}
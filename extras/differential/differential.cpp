@@ -0,0 +1,908 @@
+/**
+ * Differential test of the rendering paths on the host.
+ * Renders the templates of a corpus and of a random generator with the
+ * reference path (the Parser on the source) and with every other path
+ * (compiling, the compiled program, a program compiled on a host, the output
+ * cache), for several sets of GPIO values, and compares the bytes of the HTML
+ * and the error codes.
+ *
+ * Usage: aalec_pug_differential [--corpus DIR] [--random N] [--seed N]
+ *                               [--root DIR] [--verbose]
+ */
+#include <AALeC-V2.h>
+#include <AALeC-pug.h>
+#include <LittleFS.h>
+#include <cache/cache.h>
+#include <compiler/compiler.h>
+#include <parser/parser.h>
+
+#include "../benchmark/support.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Output that keeps the HTML
+ */
+class StringOutput : public Print {
+   public:
+    /**
+     * @brief The written bytes
+     */
+    std::string text;
+
+    size_t write(uint8_t value) override {
+        text += (char)value;
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        text.append((const char *)buffer, size);
+        return size;
+    }
+};
+
+/**
+ * @brief The ways a template can be rendered
+ */
+enum class Engine {
+    Parser,
+    Compile,
+    Program,
+    Precompiled,
+    Cache,
+};
+
+/**
+ * @brief Name of an engine
+ *
+ * @param engine The engine
+ * @return const char* The name, eg: "program"
+ */
+static const char *engineName(Engine engine) {
+    switch (engine) {
+        case Engine::Parser:
+            return "parser";
+        case Engine::Compile:
+            return "compile";
+        case Engine::Program:
+            return "program";
+        case Engine::Precompiled:
+            return "precompiled";
+        case Engine::Cache:
+            return "cache";
+    }
+
+    return "";
+}
+
+/**
+ * @brief Result of one render
+ */
+class Rendering {
+   public:
+    /**
+     * @brief Wether rendering was successful
+     */
+    bool success;
+
+    /**
+     * @brief The HTML
+     */
+    std::string html;
+
+    /**
+     * @brief Codes of the reported errors in their order, eg: "1-8 2-4",
+     *        each code only once
+     */
+    std::string errors;
+};
+
+/**
+ * @brief Values of the GPIOs of one comparison
+ */
+class GPIOValues {
+   public:
+    uint8_t led;
+    uint8_t button;
+    uint8_t rotate;
+    float temp;
+    float humidity;
+    uint16_t analog;
+};
+
+/**
+ * @brief The values every template is rendered with
+ */
+static const GPIOValues gpioValues[] = {
+    {0, 0, 0, 21.5f, 40.0f, 0},
+    {1, 1, 1, 3.2f, 55.5f, 512},
+    {0, 1, 3, 30.0f, 10.0f, 1023},
+};
+
+/**
+ * @brief Options of the command line
+ */
+class DifferentialOptions {
+   public:
+    std::string corpus;
+    size_t random = 0;
+    uint32_t seed = 1;
+    std::string root;
+    bool verbose = false;
+};
+
+/**
+ * @brief Generates random templates from the features of the README.
+ *        Uses only the output of `std::mt19937`, so a seed gives the same
+ *        templates everywhere
+ */
+class TemplateGenerator {
+   private:
+    /**
+     * @brief The random numbers
+     */
+    std::mt19937 random_;
+
+    /**
+     * @brief The indentation of one level, eg: two spaces
+     */
+    std::string indentation_;
+
+   public:
+    /**
+     * @brief Construct a new TemplateGenerator object
+     *
+     * @param seed The seed
+     */
+    TemplateGenerator(uint32_t seed);
+
+    /**
+     * @brief Generate a template
+     *
+     * @return std::string The template
+     */
+    std::string generate();
+
+    /**
+     * @brief Write the files the templates include
+     *
+     * @param root The file system root on the host
+     */
+    static void writePartials(const std::string &root);
+
+   private:
+    /**
+     * @brief A random number
+     *
+     * @param count Amount of possible numbers
+     * @return size_t The number, less than the count
+     */
+    size_t pick(size_t count);
+
+    /**
+     * @brief Decide randomly
+     *
+     * @param percent Chance of true in percent
+     * @return bool The decision
+     */
+    bool chance(size_t percent);
+
+    /**
+     * @brief Lines at one level of indentation
+     *
+     * @param out Gets the lines appended
+     * @param depth The level
+     * @param count Amount of parts
+     */
+    void block(std::string &out, size_t depth, size_t count);
+
+    /**
+     * @brief A tag with the lines of its children
+     *
+     * @param out Gets the lines appended
+     * @param depth The level of the tag
+     */
+    void tag(std::string &out, size_t depth);
+
+    /**
+     * @brief A conditional with its branches
+     *
+     * @param out Gets the lines appended
+     * @param depth The level of the conditional
+     */
+    void conditional(std::string &out, size_t depth);
+
+    /**
+     * @brief The start of a tag: name, ID literal, class literal, attributes
+     *
+     * @return std::string The start of the tag
+     */
+    std::string tagHead();
+
+    /**
+     * @brief Attributes in parentheses
+     *
+     * @return std::string The attributes
+     */
+    std::string attributes();
+
+    /**
+     * @brief Text with GPIO values and tag interpolations
+     *
+     * @param nesting How deep tag interpolations can still be nested
+     * @return std::string The text without a '\n'
+     */
+    std::string text(size_t nesting);
+
+    /**
+     * @brief An expression of a conditional or a boolean attribute
+     *
+     * @return std::string The expression
+     */
+    std::string expression();
+
+    /**
+     * @brief A key of an expression
+     *
+     * @return std::string The key, eg: "IO_BUTTON" or "3"
+     */
+    std::string key();
+
+    /**
+     * @brief A GPIO ID
+     *
+     * @return std::string The GPIO ID, eg: "IO_TEMP"
+     */
+    std::string gpio();
+
+    /**
+     * @brief The indentation of a level
+     *
+     * @param depth The level
+     * @return std::string The indentation
+     */
+    std::string indent(size_t depth);
+};
+
+TemplateGenerator::TemplateGenerator(uint32_t seed) :
+    random_(seed),
+    indentation_("  ") {}
+
+std::string TemplateGenerator::generate() {
+    static const char *indentations[] = {"  ", "    ", "\t"};
+    indentation_ = indentations[pick(3)];
+
+    std::string out;
+    if (chance(50)) {
+        static const char *doctypes[] = {
+            "html",
+            "xml",
+            "transitional",
+            "strict",
+            "frameset",
+            "1.1",
+            "basic",
+            "mobile",
+            "plist",
+            "custom thing",
+        };
+        out += std::string("doctype ") + doctypes[pick(10)] + "\n";
+    }
+    block(out, 0, 1 + pick(6));
+
+    return out;
+}
+
+void TemplateGenerator::writePartials(const std::string &root) {
+    writeFile(
+        root,
+        "/partials/part.pug",
+        "section.part\n"
+        "  h2 Part #{IO_ROTATE}\n"
+        "  if IO_LED:\n"
+        "    p LED on\n"
+        "  include leaf.pug\n"
+    );
+    writeFile(root, "/partials/leaf.pug", "span.leaf #{IO_TEMP}\n");
+    writeFile(root, "/partials/plain.css", "body { margin: 0; }\n");
+}
+
+size_t TemplateGenerator::pick(size_t count) {
+    return random_() % count;
+}
+
+bool TemplateGenerator::chance(size_t percent) {
+    return pick(100) < percent;
+}
+
+void TemplateGenerator::block(std::string &out, size_t depth, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        size_t kind = pick(100);
+        if (kind < 50 || depth > 5) {
+            tag(out, depth);
+        } else if (kind < 65) {
+            conditional(out, depth);
+        } else if (kind < 75) {
+            out += indent(depth) + "| " + text(2) + "\n";
+        } else if (kind < 80) {
+            out += indent(depth) + "<em>" + text(0) + "</em>\n";
+        } else if (kind < 85) {
+            out += indent(depth) + (chance(50) ? "// " : "//- ") + text(0)
+                + "\n";
+        } else if (kind < 90) {
+            out += indent(depth) + (chance(50) ? "//\n" : "//-\n");
+            out += indent(depth + 1) + text(0) + "\n";
+            out += indent(depth + 1) + text(0) + "\n";
+        } else if (kind < 97) {
+            // Absolute and relative paths, nested includes
+            out += indent(depth)
+                + (chance(50) ? "include /partials/part.pug\n"
+                              : "include partials/leaf.pug\n");
+        } else {
+            // Plain files are copied
+            out += indent(depth) + "style\n";
+            out += indent(depth + 1) + "include /partials/plain.css\n";
+        }
+    }
+}
+
+void TemplateGenerator::tag(std::string &out, size_t depth) {
+    out += indent(depth) + tagHead();
+
+    // Block expansions, each level can have text
+    while (chance(10)) {
+        out += ": " + tagHead();
+    }
+
+    size_t kind = pick(100);
+    if (kind < 5) {
+        out += "/\n";
+        return;
+    } else if (kind < 15) {
+        out += ".\n";
+        for (size_t i = 0, count = 1 + pick(3); i < count; i++) {
+            out += indent(depth + 1) + text(1) + "\n";
+        }
+        return;
+    } else if (kind < 60) {
+        out += " " + text(2);
+    }
+    out += "\n";
+
+    if (depth < 5 && chance(50)) {
+        block(out, depth + 1, 1 + pick(3));
+    }
+}
+
+void TemplateGenerator::conditional(std::string &out, size_t depth) {
+    out += indent(depth) + (chance(70) ? "if " : "unless ") + expression()
+        + ":\n";
+    block(out, depth + 1, 1 + pick(2));
+
+    for (size_t i = 0, count = pick(3); i < count; i++) {
+        out += indent(depth) + (chance(70) ? "else if " : "else unless ")
+            + expression() + ":\n";
+        block(out, depth + 1, 1 + pick(2));
+    }
+
+    if (chance(50)) {
+        out += indent(depth) + "else:\n";
+        block(out, depth + 1, 1 + pick(2));
+    }
+}
+
+std::string TemplateGenerator::tagHead() {
+    static const char *names[] = {
+        "div",
+        "p",
+        "span",
+        "a",
+        "b",
+        "ul",
+        "li",
+        "section",
+        "title",
+        "script",
+        "textarea",
+        "img",
+        "br",
+        "input",
+        "widget",
+    };
+
+    std::string head;
+    bool literal = false;
+    if (chance(80)) {
+        head += names[pick(15)];
+    }
+    if (chance(20)) {
+        head += "#id" + std::to_string(pick(10));
+        literal = true;
+    }
+    if (chance(30) || (head.empty() && !literal)) {
+        head += ".class" + std::to_string(pick(10));
+    }
+    if (chance(40)) {
+        head += attributes();
+    }
+
+    return head;
+}
+
+std::string TemplateGenerator::attributes() {
+    static const char *keys[] = {
+        "title",
+        "href",
+        "name",
+        "value",
+        "checked",
+        "disabled",
+    };
+    static const char *values[] = {
+        "=\"plain\"",
+        "='single'",
+        "=\"a&b <c> 'd'\"",
+        "!=\"a&b <c>\"",
+        "",
+        "=True",
+        "=False",
+        "=7",
+    };
+
+    std::string out = "(";
+    for (size_t i = 0, count = 1 + pick(3); i < count; i++) {
+        if (i > 0) {
+            out += chance(50) ? " " : ", ";
+        }
+        out += keys[pick(6)];
+        if (chance(20)) {
+            out += "=" + expression();
+        } else {
+            out += values[pick(8)];
+        }
+    }
+
+    return out + ")";
+}
+
+std::string TemplateGenerator::text(size_t nesting) {
+    static const char *words[] = {
+        "alpha",
+        "beta",
+        "value",
+        "of the",
+        "page",
+        "<i>literal</i>",
+        "a & b",
+        "(x)",
+    };
+
+    std::string out = words[pick(8)];
+    for (size_t i = 0, count = pick(4); i < count; i++) {
+        size_t kind = pick(100);
+        if (kind < 35) {
+            out += " #{" + gpio() + "}";
+        } else if (kind < 50 && nesting > 0) {
+            static const char *tags[] = {"b", "em", "span.tag"};
+            out += std::string(" #[") + tags[pick(3)] + " " + text(nesting - 1)
+                + "]";
+        } else if (kind < 51) {
+            // Unknown GPIOs stop the render with an error
+            out += " #{IO_NONE}";
+        } else {
+            out += std::string(" ") + words[pick(8)];
+        }
+    }
+
+    return out;
+}
+
+std::string TemplateGenerator::expression() {
+    if (chance(50)) {
+        return chance(80) ? gpio() : key();
+    }
+
+    return "(" + key() + " = " + key() + ")";
+}
+
+std::string TemplateGenerator::key() {
+    size_t kind = pick(100);
+    if (kind < 50) {
+        return gpio();
+    } else if (kind < 60) {
+        return "True";
+    } else if (kind < 70) {
+        return "False";
+    }
+
+    return std::to_string(pick(4));
+}
+
+std::string TemplateGenerator::gpio() {
+    static const char *gpios[] = {
+        "IO_LED",
+        "IO_BUTTON",
+        "IO_ROTATE",
+        "IO_TEMP",
+        "IO_HUMIDITY",
+        "IO_ANALOG",
+        "IO_TEMP_AGE",
+        "IO_HUMIDITY_AGE",
+    };
+
+    return gpios[pick(8)];
+}
+
+std::string TemplateGenerator::indent(size_t depth) {
+    std::string out;
+    for (size_t i = 0; i < depth; i++) {
+        out += indentation_;
+    }
+
+    return out;
+}
+
+/**
+ * @brief The codes of the errors in a log
+ *
+ * @param log The log
+ * @return std::string The codes in their order, each one only once
+ */
+static std::string errorCodes(const std::string &log) {
+    std::string codes;
+    for (size_t start = log.find("Error "); start != std::string::npos;
+         start = log.find("Error ", start + 1)) {
+        size_t end = log.find(':', start);
+        std::string code = log.substr(start + 6, end - start - 6);
+        if ((" " + codes + " ").find(" " + code + " ") == std::string::npos) {
+            codes += (codes.empty() ? "" : " ") + code;
+        }
+    }
+
+    return codes;
+}
+
+/**
+ * @brief Render a template
+ *
+ * @param path Path of the template in the file system
+ * @param engine How it is rendered
+ * @return Rendering The result
+ */
+static Rendering render(const String &path, Engine engine) {
+    Rendering rendering = Rendering();
+    StringOutput out = StringOutput();
+    std::string log;
+    Serial.setSink(&log);
+
+    GPIOSnapshot gpios = GPIOSnapshot();
+    switch (engine) {
+        case Engine::Parser: {
+            ArenaScope arena = ArenaScope();
+            Parser parser = Parser(path, out, gpios);
+            rendering.success = parser.parse();
+            break;
+        }
+        case Engine::Compile:
+            LittleFS.remove(path + ".prg");
+            rendering.success = aalec_pug(path, out, gpios);
+            break;
+        case Engine::Program:
+            rendering.success = aalec_pug(path, out, gpios);
+            break;
+        case Engine::Precompiled: {
+            // Compiled as on a host, the render takes the program over
+            {
+                ArenaScope arena = ArenaScope();
+                Compiler compiler = Compiler(path, true);
+                compiler.compile();
+            }
+            rendering.success = aalec_pug(path, out, gpios);
+            break;
+        }
+        case Engine::Cache: {
+            // The first render fills the cache, the second one is answered
+            // from it
+            outputCache.setBudget(1 << 20);
+            StringOutput first = StringOutput();
+            GPIOSnapshot firstGPIOs = GPIOSnapshot();
+            aalec_pug(path, first, firstGPIOs);
+            rendering.success = aalec_pug(path, out, gpios);
+            outputCache.setBudget(0);
+            break;
+        }
+    }
+
+    Serial.setSink(nullptr);
+    rendering.html = out.text;
+    rendering.errors = errorCodes(log);
+
+    return rendering;
+}
+
+/**
+ * @brief Part of an HTML around a position, for messages
+ *
+ * @param html The HTML
+ * @param position The position
+ * @return std::string The part with escaped newlines
+ */
+static std::string excerpt(const std::string &html, size_t position) {
+    size_t start = position > 20 ? position - 20 : 0;
+    std::string out;
+    for (char value : html.substr(start, 40)) {
+        out += value == '\n' ? std::string("\\n") : std::string(1, value);
+    }
+
+    return out;
+}
+
+/**
+ * @brief Compare a rendering to the reference and report the difference
+ *
+ * @param name Name of the template
+ * @param description The GPIO values, the tag values and the engine
+ * @param reference The rendering of the Parser
+ * @param rendering The other rendering
+ * @return bool Wether they are the same
+ */
+static bool compare(
+    const std::string &name,
+    const std::string &description,
+    const Rendering &reference,
+    const Rendering &rendering
+) {
+    if (reference.success != rendering.success) {
+        fprintf(
+            stderr,
+            "Mismatch: %s (%s): %s instead of %s\n",
+            name.c_str(),
+            description.c_str(),
+            rendering.success ? "success" : "failure",
+            reference.success ? "success" : "failure"
+        );
+        return false;
+    }
+
+    if (reference.errors != rendering.errors) {
+        fprintf(
+            stderr,
+            "Mismatch: %s (%s): errors '%s' instead of '%s'\n",
+            name.c_str(),
+            description.c_str(),
+            rendering.errors.c_str(),
+            reference.errors.c_str()
+        );
+        return false;
+    }
+
+    if (reference.html != rendering.html) {
+        size_t position = 0;
+        while (position < reference.html.size()
+               && position < rendering.html.size()
+               && reference.html[position] == rendering.html[position]) {
+            position++;
+        }
+        fprintf(
+            stderr,
+            "Mismatch: %s (%s): HTML differs at byte %zu\n"
+            "  expected: %s\n"
+            "  actual:   %s\n",
+            name.c_str(),
+            description.c_str(),
+            position,
+            excerpt(reference.html, position).c_str(),
+            excerpt(rendering.html, position).c_str()
+        );
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Counts of a run
+ */
+class DifferentialStats {
+   public:
+    size_t templates;
+    size_t failing;
+    size_t renderings;
+    size_t mismatches;
+};
+
+/**
+ * @brief Render a template with every engine, GPIO values and tag values
+ *        and compare the results to the Parser
+ *
+ * @param name Name of the template
+ * @param path Path of the template in the file system
+ * @param verbose Wether every template is listed
+ * @param stats Gets the counts added
+ * @return bool Wether every rendering matched
+ */
+static bool check(
+    const std::string &name,
+    const String &path,
+    bool verbose,
+    DifferentialStats &stats
+) {
+    bool same = true;
+    bool failing = false;
+    for (bool tagValues : {false, true}) {
+        aalec_pug_tag_values(tagValues);
+
+        for (size_t i = 0; i < sizeof(gpioValues) / sizeof(gpioValues[0]);
+             i++) {
+            aalec.led = gpioValues[i].led;
+            aalec.button = gpioValues[i].button;
+            aalec.rotate = gpioValues[i].rotate;
+            aalec.temp = gpioValues[i].temp;
+            aalec.humidity = gpioValues[i].humidity;
+            aalec.analog = gpioValues[i].analog;
+
+            Rendering reference = render(path, Engine::Parser);
+            failing |= !reference.success;
+            stats.renderings++;
+
+            for (Engine engine :
+                 {Engine::Compile,
+                  Engine::Program,
+                  Engine::Precompiled,
+                  Engine::Cache}) {
+                std::string description = "values " + std::to_string(i)
+                    + (tagValues ? ", tag values" : "") + ", "
+                    + engineName(engine);
+                Rendering rendering = render(path, engine);
+                stats.renderings++;
+
+                if (!compare(name, description, reference, rendering)) {
+                    stats.mismatches++;
+                    same = false;
+                }
+            }
+        }
+    }
+    aalec_pug_tag_values(false);
+
+    stats.templates++;
+    if (failing) {
+        stats.failing++;
+    }
+    if (verbose) {
+        printf(
+            "%-40s %s%s\n",
+            name.c_str(),
+            same ? "same" : "DIFFERENT",
+            failing ? " (errors)" : ""
+        );
+    }
+
+    return same;
+}
+
+/**
+ * @brief Parse the command line
+ *
+ * @param argc Amount of arguments
+ * @param argv The arguments
+ * @param options Gets the options
+ * @return bool Wether the arguments are valid
+ */
+static bool parseOptions(int argc, char **argv, DifferentialOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--verbose") {
+            options.verbose = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--corpus") {
+            options.corpus = value;
+        } else if (option == "--random") {
+            options.random = std::stoul(value);
+        } else if (option == "--seed") {
+            options.seed = std::stoul(value);
+        } else if (option == "--root") {
+            options.root = value;
+        } else {
+            return false;
+        }
+    }
+
+    return !options.corpus.empty() || options.random > 0;
+}
+
+int main(int argc, char **argv) {
+    DifferentialOptions options = DifferentialOptions();
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(
+            stderr,
+            "Usage: %s [--corpus DIR] [--random N] [--seed N] [--root DIR] "
+            "[--verbose]\n",
+            argv[0]
+        );
+        return 2;
+    }
+
+    // The templates are copied into a fresh directory, so the programs
+    // aren't written next to the corpus
+    bool temporary = options.root.empty();
+    if (temporary) {
+        options.root = temporaryRoot("differential");
+    }
+    std::filesystem::create_directories(options.root);
+    LittleFS.setRoot(options.root);
+
+    DifferentialStats stats = DifferentialStats();
+    bool same = true;
+
+    // The corpus, with its included files
+    std::vector<std::string> templates;
+    if (!options.corpus.empty()) {
+        for (const auto &entry :
+             std::filesystem::recursive_directory_iterator(options.corpus)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+
+            std::string path = "/"
+                + std::filesystem::relative(entry.path(), options.corpus)
+                      .generic_string();
+            std::ifstream file = std::ifstream(entry.path(), std::ios::binary);
+            std::ostringstream content;
+            content << file.rdbuf();
+            writeFile(options.root, path, content.str());
+
+            // Included files are only checked as part of their templates
+            if (entry.path().extension() == ".pug"
+                && path.find('/', 1) == std::string::npos) {
+                templates.push_back(path);
+            }
+        }
+    }
+    std::sort(templates.begin(), templates.end());
+    for (const std::string &path : templates) {
+        same &= check(path, String(path.c_str()), options.verbose, stats);
+    }
+
+    // The random templates, a mismatch shows the template
+    TemplateGenerator::writePartials(options.root);
+    TemplateGenerator generator = TemplateGenerator(options.seed);
+    for (size_t i = 0; i < options.random; i++) {
+        std::string content = generator.generate();
+        std::string path = "/random" + std::to_string(i) + ".pug";
+        writeFile(options.root, path, content);
+
+        std::string name = "random " + std::to_string(i) + " (seed "
+            + std::to_string(options.seed) + ")";
+        if (!check(name, String(path.c_str()), options.verbose, stats)) {
+            fprintf(stderr, "--- %s\n%s---\n", name.c_str(), content.c_str());
+            same = false;
+        }
+    }
+
+    printf(
+        "%zu templates (%zu with errors), %zu renderings, %zu mismatches\n",
+        stats.templates,
+        stats.failing,
+        stats.renderings,
+        stats.mismatches
+    );
+
+    if (temporary) {
+        std::filesystem::remove_all(options.root);
+    }
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include "AALeC-V2.h"
+
+#include <chrono>
+#include <thread>
+
+c_AALeC aalec;
+
+static void simulateLatency(unsigned long us) {
+    if (us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+c_AALeC::c_AALeC() :
+    led(0),
+    button(0),
+    rotate(0),
+    temp(21.5f),
+    humidity(40.0f),
+    analog(512),
+    dhtLatencyUs(0),
+    reads() {}
+
+void c_AALeC::init() {}
+
+int c_AALeC::get_led() {
+    reads[0]++;
+    return led;
+}
+
+int c_AALeC::get_button() {
+    reads[1]++;
+    return button;
+}
+
+int c_AALeC::get_rotate() {
+    reads[2]++;
+    return rotate;
+}
+
+float c_AALeC::get_temp() {
+    reads[3]++;
+    simulateLatency(dhtLatencyUs);
+    return temp;
+}
+
+float c_AALeC::get_humidity() {
+    reads[4]++;
+    simulateLatency(dhtLatencyUs);
+    return humidity;
+}
+
+int c_AALeC::get_analog() {
+    reads[5]++;
+    return analog;
+}
+
+void c_AALeC::resetReads() {
+    for (unsigned long &count : reads) {
+        count = 0;
+    }
+}
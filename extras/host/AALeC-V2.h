@@ -0,0 +1,59 @@
+#ifndef AALEC_V2_H
+#define AALEC_V2_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Host stand-in for the AALeC board with configurable fake sensor
+ *        values and read latencies
+ */
+class c_AALeC {
+   public:
+    /**
+     * @brief The fake sensor values, returned by the getters
+     */
+    int led;
+    int button;
+    int rotate;
+    float temp;
+    float humidity;
+    int analog;
+
+    /**
+     * @brief Simulated latency of a temperature or humidity read in microseconds
+     */
+    unsigned long dhtLatencyUs;
+
+    /**
+     * @brief Number of reads per sensor, in the order of the getters
+     */
+    unsigned long reads[6];
+
+    /**
+     * @brief Construct a new c_AALeC object with plausible values
+     */
+    c_AALeC();
+
+    void init();
+
+    int get_led();
+
+    int get_button();
+
+    int get_rotate();
+
+    float get_temp();
+
+    float get_humidity();
+
+    int get_analog();
+
+    /**
+     * @brief Set all read counters to 0
+     */
+    void resetReads();
+};
+
+extern c_AALeC aalec;
+
+#endif  // AALEC_V2_H
@@ -0,0 +1,437 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <string>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+/**
+ * @brief Flash and RAM share one address space on the host, PROGMEM data
+ *        is only put into its own section when AALEC_PUG_HOST_PROGMEM_SECTION
+ *        is defined, so `size -A` shows what would stay in flash
+ */
+#ifdef AALEC_PUG_HOST_PROGMEM_SECTION
+    #define PROGMEM __attribute__((section(".progmem")))
+    #define PSTR(s)                                   \
+        (__extension__({                              \
+            static const char __pstr[] PROGMEM = (s); \
+            &__pstr[0];                               \
+        }))
+#else
+    #define PROGMEM
+    #define PSTR(s) (s)
+#endif
+#define PGM_P const char *
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(const void *const *)(addr))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcmp_P memcmp
+#define memcpy_P memcpy
+#define vsnprintf_P vsnprintf
+#define snprintf_P snprintf
+
+class __FlashStringHelper;
+
+/**
+ * @brief Host stand-in for the Arduino String class
+ */
+class String {
+   private:
+    std::string value_;
+
+   public:
+    String() {}
+
+    String(const char *value) : value_(value ? value : "") {}
+
+    String(const char *value, size_t length) : value_(value, length) {}
+
+    String(const __FlashStringHelper *value) :
+        value_(reinterpret_cast<const char *>(value)) {}
+
+    explicit String(char value) : value_(1, value) {}
+
+    explicit String(int value) : value_(std::to_string(value)) {}
+
+    explicit String(unsigned int value) : value_(std::to_string(value)) {}
+
+    explicit String(long value) : value_(std::to_string(value)) {}
+
+    explicit String(unsigned long value) : value_(std::to_string(value)) {}
+
+    const char *c_str() const {
+        return value_.c_str();
+    }
+
+    unsigned int length() const {
+        return value_.length();
+    }
+
+    bool isEmpty() const {
+        return value_.empty();
+    }
+
+    bool reserve(unsigned int size) {
+        value_.reserve(size);
+        return true;
+    }
+
+    void clear() {
+        value_.clear();
+    }
+
+    char operator[](unsigned int index) const {
+        return index < value_.length() ? value_[index] : 0;
+    }
+
+    char &operator[](unsigned int index) {
+        return value_[index];
+    }
+
+    char charAt(unsigned int index) const {
+        return (*this)[index];
+    }
+
+    const char *begin() const {
+        return value_.data();
+    }
+
+    const char *end() const {
+        return value_.data() + value_.length();
+    }
+
+    bool concat(const String &value) {
+        value_ += value.value_;
+        return true;
+    }
+
+    bool concat(const char *value) {
+        value_ += value;
+        return true;
+    }
+
+    bool concat(const char *value, unsigned int length) {
+        value_.append(value, length);
+        return true;
+    }
+
+    bool concat(char value) {
+        value_ += value;
+        return true;
+    }
+
+    bool concat(unsigned int value) {
+        value_ += std::to_string(value);
+        return true;
+    }
+
+    String &operator+=(const String &value) {
+        concat(value);
+        return *this;
+    }
+
+    String &operator+=(const char *value) {
+        concat(value);
+        return *this;
+    }
+
+    String &operator+=(char value) {
+        concat(value);
+        return *this;
+    }
+
+    String &operator+=(unsigned int value) {
+        concat(value);
+        return *this;
+    }
+
+    friend String operator+(const String &left, const String &right) {
+        String result(left);
+        result += right;
+        return result;
+    }
+
+    friend String operator+(const String &left, const char *right) {
+        String result(left);
+        result += right;
+        return result;
+    }
+
+    friend String operator+(const char *left, const String &right) {
+        String result(left);
+        result += right;
+        return result;
+    }
+
+    bool equals(const String &value) const {
+        return value_ == value.value_;
+    }
+
+    bool equals(const char *value) const {
+        return value_ == value;
+    }
+
+    bool operator==(const String &value) const {
+        return equals(value);
+    }
+
+    bool operator==(const char *value) const {
+        return equals(value);
+    }
+
+    bool operator!=(const String &value) const {
+        return !equals(value);
+    }
+
+    bool operator!=(const char *value) const {
+        return !equals(value);
+    }
+
+    bool operator<(const String &value) const {
+        return value_ < value.value_;
+    }
+
+    bool startsWith(const String &value) const {
+        return value_.compare(0, value.length(), value.value_) == 0;
+    }
+
+    bool endsWith(const String &value) const {
+        return value_.length() >= value.length()
+            && value_.compare(
+                   value_.length() - value.length(),
+                   value.length(),
+                   value.value_
+               ) == 0;
+    }
+
+    int indexOf(char value, unsigned int from = 0) const {
+        size_t index = value_.find(value, from);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+
+    int indexOf(const String &value, unsigned int from = 0) const {
+        size_t index = value_.find(value.value_, from);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+
+    int lastIndexOf(char value) const {
+        size_t index = value_.rfind(value);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+
+    int lastIndexOf(const String &value) const {
+        size_t index = value_.rfind(value.value_);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+
+    String substring(unsigned int from) const {
+        return substring(from, value_.length());
+    }
+
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) {
+            unsigned int temp = from;
+            from = to;
+            to = temp;
+        }
+        if (from > value_.length()) {
+            return String();
+        }
+        if (to > value_.length()) {
+            to = value_.length();
+        }
+        return String(value_.data() + from, to - from);
+    }
+
+    long toInt() const {
+        return atol(value_.c_str());
+    }
+};
+
+/**
+ * @brief Host stand-in for the Arduino Print class
+ */
+class Print {
+   public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t value) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t written = 0;
+        while (size--) {
+            if (!write(*buffer++)) {
+                break;
+            }
+            written++;
+        }
+        return written;
+    }
+
+    size_t write(const char *buffer, size_t size) {
+        return write((const uint8_t *)buffer, size);
+    }
+
+    size_t write(const char *value) {
+        return value ? write((const uint8_t *)value, strlen(value)) : 0;
+    }
+
+    size_t print(const char *value) {
+        return write(value);
+    }
+
+    size_t print(const __FlashStringHelper *value) {
+        return write(reinterpret_cast<const char *>(value));
+    }
+
+    size_t print(const String &value) {
+        return write(value.c_str(), value.length());
+    }
+
+    size_t print(char value) {
+        return write((uint8_t)value);
+    }
+
+    size_t print(int value) {
+        return print(String(value));
+    }
+
+    size_t print(unsigned int value) {
+        return print(String(value));
+    }
+
+    size_t print(long value) {
+        return print(String(value));
+    }
+
+    size_t print(unsigned long value) {
+        return print(String(value));
+    }
+
+    size_t println() {
+        return print("\r\n");
+    }
+
+    template<typename T>
+    size_t println(const T &value) {
+        return print(value) + println();
+    }
+
+    size_t printf(const char *format, ...)
+        __attribute__((format(printf, 2, 3))) {
+        va_list arguments;
+        va_start(arguments, format);
+        size_t written = vprintf(format, arguments);
+        va_end(arguments);
+        return written;
+    }
+
+    size_t printf_P(PGM_P format, ...) {
+        va_list arguments;
+        va_start(arguments, format);
+        size_t written = vprintf(format, arguments);
+        va_end(arguments);
+        return written;
+    }
+
+    size_t vprintf(const char *format, va_list arguments) {
+        va_list copy;
+        va_copy(copy, arguments);
+        char small[64];
+        int length = vsnprintf(small, sizeof(small), format, copy);
+        va_end(copy);
+        if (length < 0) {
+            return 0;
+        }
+        if ((size_t)length < sizeof(small)) {
+            return write(small, length);
+        }
+        std::string large(length + 1, '\0');
+        vsnprintf(&large[0], large.size(), format, arguments);
+        return write(large.data(), length);
+    }
+
+    virtual void flush() {}
+};
+
+/**
+ * @brief Host stand-in for the Arduino Stream class
+ */
+class Stream : public Print {
+   public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/**
+ * @brief Host stand-in for the hardware serial port, writes to stderr
+ *        unless an other sink is set with `setSink()`
+ */
+class HardwareSerial : public Print {
+   private:
+    std::string *sink_;
+
+   public:
+    HardwareSerial() : sink_(nullptr) {}
+
+    void begin(unsigned long) {}
+
+    /**
+     * @brief Capture the output into a string instead of printing it
+     *
+     * @param sink The string to append to, nullptr to print to stderr
+     */
+    void setSink(std::string *sink) {
+        sink_ = sink;
+    }
+
+    size_t write(uint8_t value) override {
+        return write(&value, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        if (sink_) {
+            sink_->append((const char *)buffer, size);
+        } else {
+            fwrite(buffer, 1, size, stderr);
+        }
+        return size;
+    }
+};
+
+extern HardwareSerial Serial;
+
+inline bool isAlphaNumeric(int c) {
+    return isalnum(c) != 0;
+}
+
+inline bool isDigit(int c) {
+    return isdigit(c) != 0;
+}
+
+unsigned long millis();
+
+unsigned long micros();
+
+void delay(unsigned long ms);
+
+inline void yield() {}
+
+#endif  // ARDUINO_H
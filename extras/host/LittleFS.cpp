@@ -0,0 +1,191 @@
+#include "LittleFS.h"
+
+#include <sys/stat.h>
+
+LittleFSHost LittleFS;
+
+File::File() : handle_(), name_(""), isDirectory_(false) {}
+
+File::File(std::shared_ptr<FILE> handle, String name, bool isDirectory) :
+    handle_(handle),
+    name_(name),
+    isDirectory_(isDirectory) {}
+
+File::operator bool() const {
+    return handle_ != nullptr || isDirectory_;
+}
+
+bool File::isFile() const {
+    return handle_ != nullptr;
+}
+
+bool File::isDirectory() const {
+    return isDirectory_;
+}
+
+const char *File::name() const {
+    return name_.c_str();
+}
+
+size_t File::size() const {
+    if (!handle_) {
+        return 0;
+    }
+    struct stat info;
+    fflush(handle_.get());
+    if (fstat(fileno(handle_.get()), &info) != 0) {
+        return 0;
+    }
+    return info.st_size;
+}
+
+size_t File::position() const {
+    if (!handle_) {
+        return 0;
+    }
+    long position = ftell(handle_.get());
+    return position < 0 ? 0 : position;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+    if (!handle_) {
+        return false;
+    }
+    int whence = mode == SeekSet   ? SEEK_SET
+               : mode == SeekCur ? SEEK_CUR
+                                 : SEEK_END;
+    long offset = mode == SeekCur ? (long)(int32_t)position : (long)position;
+    return fseek(handle_.get(), offset, whence) == 0;
+}
+
+int File::available() {
+    if (!handle_) {
+        return 0;
+    }
+    size_t total = size();
+    size_t current = position();
+    return current < total ? total - current : 0;
+}
+
+int File::read() {
+    if (!handle_) {
+        return -1;
+    }
+    int value = fgetc(handle_.get());
+    return value == EOF ? -1 : value;
+}
+
+size_t File::read(uint8_t *buffer, size_t size) {
+    if (!handle_) {
+        return 0;
+    }
+    return fread(buffer, 1, size, handle_.get());
+}
+
+int File::peek() {
+    if (!handle_) {
+        return -1;
+    }
+    int value = fgetc(handle_.get());
+    if (value == EOF) {
+        clearerr(handle_.get());
+        return -1;
+    }
+    ungetc(value, handle_.get());
+    return value;
+}
+
+size_t File::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    if (!handle_) {
+        return 0;
+    }
+    return fwrite(buffer, 1, size, handle_.get());
+}
+
+String File::readString() {
+    String value;
+    char buffer[256];
+    size_t length;
+    while ((length = read((uint8_t *)buffer, sizeof(buffer))) > 0) {
+        value.concat(buffer, length);
+    }
+    return value;
+}
+
+time_t File::getLastWrite() const {
+    if (!handle_) {
+        return 0;
+    }
+    struct stat info;
+    if (fstat(fileno(handle_.get()), &info) != 0) {
+        return 0;
+    }
+    return info.st_mtime;
+}
+
+void File::flush() {
+    if (handle_) {
+        fflush(handle_.get());
+    }
+}
+
+void File::close() {
+    handle_.reset();
+    isDirectory_ = false;
+}
+
+LittleFSHost::LittleFSHost() : root_(".") {}
+
+void LittleFSHost::setRoot(const std::string &root) {
+    root_ = root;
+}
+
+bool LittleFSHost::begin() {
+    return true;
+}
+
+std::string LittleFSHost::hostPath(const String &path) const {
+    std::string result = root_;
+    if (path.length() == 0 || path[0] != '/') {
+        result += '/';
+    }
+    result += path.c_str();
+    return result;
+}
+
+File LittleFSHost::open(const String &path, const char *mode) {
+    std::string host = hostPath(path);
+    struct stat info;
+    if (stat(host.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        return File(nullptr, path, true);
+    }
+
+    // LittleFS creates the parent directories of files opened for writing
+    if (mode[0] == 'w' || mode[0] == 'a') {
+        for (size_t i = root_.length() + 1; i < host.length(); i++) {
+            if (host[i] == '/') {
+                mkdir(host.substr(0, i).c_str(), 0755);
+            }
+        }
+    }
+
+    std::string hostMode = std::string(mode) + "b";
+    FILE *handle = fopen(host.c_str(), hostMode.c_str());
+    if (!handle) {
+        return File();
+    }
+    return File(std::shared_ptr<FILE>(handle, fclose), path, false);
+}
+
+bool LittleFSHost::exists(const String &path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool LittleFSHost::remove(const String &path) {
+    return ::remove(hostPath(path).c_str()) == 0;
+}
@@ -0,0 +1,113 @@
+#ifndef LITTLEFS_H
+#define LITTLEFS_H
+
+#include <Arduino.h>
+
+#include <memory>
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2,
+};
+
+/**
+ * @brief Host stand-in for a LittleFS file, backed by a stdio FILE
+ */
+class File : public Stream {
+   private:
+    /**
+     * @brief Shared handle, copies of a File refer to the same open file
+     *        like they do on the device
+     */
+    std::shared_ptr<FILE> handle_;
+
+    /**
+     * @brief Path of the file relative to the file system root
+     */
+    String name_;
+
+    /**
+     * @brief Whether the path is a directory
+     */
+    bool isDirectory_;
+
+   public:
+    File();
+
+    File(std::shared_ptr<FILE> handle, String name, bool isDirectory);
+
+    explicit operator bool() const;
+
+    bool isFile() const;
+
+    bool isDirectory() const;
+
+    const char *name() const;
+
+    size_t size() const;
+
+    size_t position() const;
+
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+
+    int available() override;
+
+    int read() override;
+
+    size_t read(uint8_t *buffer, size_t size);
+
+    int peek() override;
+
+    size_t write(uint8_t value) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    using Print::write;
+
+    String readString();
+
+    time_t getLastWrite() const;
+
+    void flush() override;
+
+    void close();
+};
+
+/**
+ * @brief Host stand-in for the LittleFS file system, backed by a directory
+ */
+class LittleFSHost {
+   private:
+    /**
+     * @brief The directory that acts as the file system root
+     */
+    std::string root_;
+
+   public:
+    LittleFSHost();
+
+    /**
+     * @brief Set the directory that acts as the file system root
+     *
+     * @param root Path to the directory
+     */
+    void setRoot(const std::string &root);
+
+    bool begin();
+
+    File open(const String &path, const char *mode);
+
+    bool exists(const String &path);
+
+    bool remove(const String &path);
+
+    /**
+     * @brief Translate a file system path to a host path
+     */
+    std::string hostPath(const String &path) const;
+};
+
+extern LittleFSHost LittleFS;
+
+#endif  // LITTLEFS_H
@@ -0,0 +1,22 @@
+#ifndef STREAMSTRING_H
+#define STREAMSTRING_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Host stand-in for the ESP8266 StreamString, a String that can be printed to
+ */
+class StreamString : public String, public Print {
+   public:
+    size_t write(uint8_t value) override {
+        concat((char)value);
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        concat((const char *)buffer, size);
+        return size;
+    }
+};
+
+#endif  // STREAMSTRING_H
@@ -0,0 +1,211 @@
+/**
+ * Checks of the live values on the host: the JSON of `aalec_pug_values()`
+ * has a key for every `data-io` span of the page, and `reload` lists
+ * exactly the GPIOs that expressions of the page read.
+ *
+ * Usage: aalec_pug_live [--root DIR]
+ */
+#include <AALeC-V2.h>
+#include <AALeC-pug.h>
+#include <LittleFS.h>
+#include <StreamString.h>
+
+#include "../benchmark/support.h"
+
+#include <filesystem>
+#include <set>
+#include <string>
+
+/**
+ * @brief A page and what `aalec_pug_values()` should write for it
+ */
+class LiveCase {
+   public:
+    /**
+     * @brief Path to the pug file
+     */
+    const char *path;
+
+    /**
+     * @brief The source
+     */
+    const char *source;
+
+    /**
+     * @brief The expected JSON
+     */
+    const char *json;
+
+    /**
+     * @brief The expected `data-io` spans, separated by spaces
+     */
+    const char *spans;
+};
+
+/**
+ * @brief The pages, with the values that are set in `main()`
+ */
+static const LiveCase cases[] = {
+    {
+        "/static.pug",
+        "p static\n",
+        "{\"reload\":[]}",
+        "",
+    },
+    {
+        // Shown and deciding which parts are shown
+        "/mixed.pug",
+        "p #{IO_TEMP} and #{IO_BUTTON}\n"
+        "if IO_BUTTON:\n"
+        "  p pressed\n",
+        "{\"IO_BUTTON\":0,\"IO_TEMP\":21,\"reload\":[\"IO_BUTTON\"]}",
+        "IO_BUTTON IO_TEMP",
+    },
+    {
+        // Values without spans only reload if an expression reads them
+        "/unwrapped.pug",
+        "head\n"
+        "  title Page #{IO_ROTATE}\n"
+        "body\n"
+        "  textarea #{IO_LED}\n"
+        "  input(checked=IO_ANALOG)\n",
+        "{\"IO_LED\":1,\"IO_ROTATE\":3,\"IO_ANALOG\":512,"
+        "\"reload\":[\"IO_ANALOG\"]}",
+        "",
+    },
+    {
+        // Expressions of included files count as well
+        "/included.pug",
+        "p #{IO_HUMIDITY}\n"
+        "include partials/rotated.pug\n",
+        "{\"IO_ROTATE\":3,\"IO_HUMIDITY\":40,\"reload\":[\"IO_ROTATE\"]}",
+        "IO_HUMIDITY",
+    },
+};
+
+/**
+ * @brief Amount of failed checks
+ */
+static size_t failures = 0;
+
+/**
+ * @brief Report a check that failed
+ *
+ * @param passed Wether the check passed
+ * @param what What was checked
+ */
+static void check(bool passed, const std::string &what) {
+    if (!passed) {
+        fprintf(stderr, "Error: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+/**
+ * @brief Find the `data-io` spans of a page
+ *
+ * @param html The HTML
+ * @return std::set<std::string> The keys of the spans
+ */
+static std::set<std::string> spansOf(const std::string &html) {
+    std::set<std::string> spans;
+    const std::string marker = "<span data-io=\"";
+    for (size_t start = html.find(marker); start != std::string::npos;
+         start = html.find(marker, start)) {
+        start += marker.size();
+        spans.insert(html.substr(start, html.find('"', start) - start));
+    }
+
+    return spans;
+}
+
+/**
+ * @brief Render a page and check its values
+ *
+ * @param page The page
+ */
+static void checkCase(const LiveCase &page) {
+    StreamString html;
+    StreamString json;
+    check(
+        aalec_pug(String(page.path), html),
+        std::string(page.path) + " failed"
+    );
+    check(
+        aalec_pug_values(String(page.path), json),
+        std::string(page.path) + " has no values"
+    );
+
+    check(
+        std::string(json.c_str()) == page.json,
+        std::string(page.path) + ": wrote " + json.c_str() + " instead of "
+            + page.json
+    );
+
+    std::string spans;
+    for (const std::string &span : spansOf(html.c_str())) {
+        spans += (spans.empty() ? "" : " ") + span;
+
+        // live.js looks the spans up by the keys of the JSON
+        check(
+            std::string(json.c_str()).find("\"" + span + "\":")
+                != std::string::npos,
+            std::string(page.path) + ": no value for the span of " + span
+        );
+    }
+    check(
+        spans == page.spans,
+        std::string(page.path) + ": spans '" + spans + "' instead of '"
+            + page.spans + "'"
+    );
+}
+
+int main(int argc, char **argv) {
+    std::string root;
+    if (argc == 3 && std::string(argv[1]) == "--root") {
+        root = argv[2];
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [--root DIR]\n", argv[0]);
+        return 2;
+    }
+
+    bool temporary = root.empty();
+    if (temporary) {
+        root = temporaryRoot("live");
+    }
+    std::filesystem::create_directories(root);
+    LittleFS.setRoot(root);
+
+    for (const LiveCase &page : cases) {
+        writeFile(root, page.path, page.source);
+    }
+    writeFile(
+        root,
+        "/partials/rotated.pug",
+        "unless (IO_ROTATE = 0):\n  p rotated\n"
+    );
+
+    aalec.led = 1;
+    aalec.button = 0;
+    aalec.rotate = 3;
+    aalec.temp = 21;
+    aalec.humidity = 40;
+    aalec.analog = 512;
+    aalec_pug_tag_values(true);
+
+    for (const LiveCase &page : cases) {
+        checkCase(page);
+    }
+
+    if (temporary) {
+        std::filesystem::remove_all(root);
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "%zu checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks of the live values passed\n");
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * Compiles pug files into programs on the host, so the device doesn't have
+ * to. The programs are written next to the sources (`<file>.pug.prg`) and
+ * uploaded with them, the device takes them over on their first load.
+ *
+ * Usage: aalec_pug_precompile [--tag-values] DIR [PATH...]
+ *
+ * DIR is the directory that is uploaded to LittleFS (eg: `data`), the paths
+ * are in the file system (eg: `/index.pug`), all pug files by default.
+ */
+#include <LittleFS.h>
+#include <compiler/compiler.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compile a pug file and report the program
+ *
+ * @param path Path to the pug file in the file system
+ * @return bool Wether the program was written and the source has no errors
+ */
+static bool precompile(const std::string &path) {
+    // The strings and vectors of the compile are released at once
+    ArenaScope arena = ArenaScope();
+
+    Compiler compiler = Compiler(String(path.c_str()), true);
+    if (!compiler.compile()) {
+        fprintf(stderr, "Error: Failed to compile '%s'\n", path.c_str());
+        return false;
+    }
+
+    std::string programPath = Program::pathFor(String(path.c_str())).c_str();
+    File program = LittleFS.open(String(programPath.c_str()), "r");
+    size_t size = program.size();
+    program.close();
+
+    printf(
+        "%s -> %s (%zu bytes, %s)%s\n",
+        path.c_str(),
+        programPath.c_str(),
+        size,
+        compiler.isInterpreted() ? "interpreted" : "compiled",
+        compiler.hasErrors() ? " with errors" : ""
+    );
+    if (compiler.hasErrors()) {
+        fprintf(
+            stderr,
+            "Error: '%s' has errors, they are printed when it is rendered\n",
+            path.c_str()
+        );
+    }
+
+    return !compiler.hasErrors();
+}
+
+int main(int argc, char **argv) {
+    std::string root;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--tag-values") {
+            // Must match `aalec_pug_tag_values()` on the device
+            Parser::setTagValues(true);
+        } else if (root.empty()) {
+            root = argument;
+        } else {
+            paths.push_back(argument);
+        }
+    }
+
+    if (root.empty() || !std::filesystem::is_directory(root)) {
+        fprintf(stderr, "Usage: %s [--tag-values] DIR [PATH...]\n", argv[0]);
+        return 2;
+    }
+    LittleFS.setRoot(root);
+
+    // All pug files of the directory by default
+    if (paths.empty()) {
+        for (const auto &entry :
+             std::filesystem::recursive_directory_iterator(root)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".pug") {
+                paths.push_back(
+                    "/"
+                    + std::filesystem::relative(entry.path(), root)
+                          .generic_string()
+                );
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+    }
+
+    bool success = true;
+    for (const std::string &path : paths) {
+        success &= precompile(path);
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/**
+ * Soak test of the memory of compiles on the host.
+ * Compiles and renders every template of a corpus round after round and
+ * checks that the heap is back where it was after the first round, so
+ * repeated compiles neither leak nor keep memory.
+ *
+ * Usage: aalec_pug_soak --corpus DIR [--rounds N] [--root DIR]
+ */
+#include <AALeC-pug.h>
+#include <LittleFS.h>
+#include <arena/arena.h>
+
+#include "../benchmark/support.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options of the command line
+ */
+class SoakOptions {
+   public:
+    std::string corpus;
+    size_t rounds = 20;
+    std::string root;
+};
+
+/**
+ * @brief Compile and render a template through every entry point
+ *
+ * @param path Path of the template in the file system
+ * @return bool Wether the template was rendered without errors
+ */
+static bool soak(const std::string &path) {
+    String inPath = String(path.c_str());
+
+    // Compile on every round, then render the program
+    LittleFS.remove(inPath + ".prg");
+    NullOutput compiled = NullOutput();
+    NullOutput rendered = NullOutput();
+    bool success = aalec_pug(inPath, compiled) && aalec_pug(inPath, rendered);
+
+    u16 gpios = 0;
+    NullOutput values = NullOutput();
+    GPIOSnapshot snapshot = GPIOSnapshot();
+    String etag;
+    aalec_pug_gpios(inPath, gpios);
+    aalec_pug_values(inPath, values);
+    aalec_pug_etag(inPath, snapshot, etag);
+
+    return success && compiled.bytes == rendered.bytes;
+}
+
+/**
+ * @brief Parse the command line
+ *
+ * @param argc Amount of arguments
+ * @param argv The arguments
+ * @param options Gets the options
+ * @return bool Wether the arguments are valid
+ */
+static bool parseOptions(int argc, char **argv, SoakOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--corpus") {
+            options.corpus = value;
+        } else if (option == "--rounds") {
+            options.rounds = std::stoul(value);
+        } else if (option == "--root") {
+            options.root = value;
+        } else {
+            return false;
+        }
+    }
+
+    return !options.corpus.empty() && options.rounds > 1;
+}
+
+int main(int argc, char **argv) {
+    SoakOptions options = SoakOptions();
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(
+            stderr,
+            "Usage: %s --corpus DIR [--rounds N] [--root DIR]\n",
+            argv[0]
+        );
+        return 2;
+    }
+
+    // The templates are copied into a fresh directory, so the programs
+    // aren't written next to the corpus
+    bool temporary = options.root.empty();
+    if (temporary) {
+        options.root = temporaryRoot("soak");
+    }
+    std::filesystem::create_directories(options.root);
+    LittleFS.setRoot(options.root);
+
+    std::vector<std::string> templates;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(options.corpus)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        std::string path = "/"
+            + std::filesystem::relative(entry.path(), options.corpus)
+                  .generic_string();
+        std::ifstream file = std::ifstream(entry.path(), std::ios::binary);
+        std::ostringstream content;
+        content << file.rdbuf();
+        writeFile(options.root, path, content.str());
+
+        if (entry.path().extension() == ".pug") {
+            templates.push_back(path);
+        }
+    }
+    std::sort(templates.begin(), templates.end());
+
+    // The errors of the failing templates are dropped after each round
+    std::string log;
+    Serial.setSink(&log);
+
+    // The first round leaves what stays for good, eg: the open file system
+    size_t live = 0;
+    size_t failing = 0;
+    bool success = true;
+    for (size_t round = 0; round < options.rounds; round++) {
+        for (const std::string &path : templates) {
+            if (!soak(path) && round == 0) {
+                failing++;
+            }
+        }
+        log.clear();
+
+        if (round == 0) {
+            live = heap.live;
+        } else if (heap.live != live) {
+            fprintf(
+                stderr,
+                "Error: Round %zu left %zd bytes more on the heap\n",
+                round + 1,
+                (ssize_t)(heap.live - live)
+            );
+            success = false;
+        }
+
+        if (compileArena.isActive() || compileArena.used() != 0) {
+            fprintf(stderr, "Error: The arena is still in use\n");
+            success = false;
+        }
+    }
+
+    Serial.setSink(nullptr);
+
+    if (heap.allocations == 0) {
+        printf("The heap isn't counted without glibc, nothing was checked\n");
+    } else {
+        printf(
+            "%zu templates (%zu with errors), %zu rounds, %zu bytes on the "
+            "heap after each round, %zu bytes peak of the arena\n",
+            templates.size(),
+            failing,
+            options.rounds,
+            live,
+            compileArena.peak()
+        );
+    }
+
+    if (temporary) {
+        std::filesystem::remove_all(options.root);
+    }
+
+    return success ? 0 : 1;
+}
@@ -2,7 +2,76 @@
 
 #include <LittleFS.h>
 
+#include "cache/cache.h"
+#include "compiler/compiler.h"
+#include "emitter/emitter.h"
+#include "etag/etag.h"
 #include "parser/parser.h"
+#include "program/program.h"
+
+/**
+ * @brief Load the program of a pug file, compiles it first if there is no up
+ *        to date program. Cached pages of a pug file that is compiled are removed
+ *
+ * @param inPath Path to the pug file
+ * @param program The program
+ * @return bool Wether the program could be loaded
+ */
+static bool loadProgram(String inPath, Program &program) {
+    if (program.load(inPath)) {
+        return true;
+    }
+
+    // The source or an included file changed
+    outputCache.remove(inPath);
+
+    // The strings and vectors of the compile are released at once, before the
+    // program is rendered
+    ArenaScope arena = ArenaScope();
+
+    Compiler compiler = Compiler(inPath);
+    return compiler.compile() && program.load(inPath);
+}
+
+/**
+ * @brief Compiles a pug file and writes the HTML to an output,
+ *        see `aalec_pug(String, Print &, GPIOSnapshot &)`.
+ *        The callers check that the pug file exists
+ *
+ * @param inPath Path to the pug file
+ * @param out Where the HTML is written to
+ * @param gpios The GPIO values
+ * @param chunkSize Size of the chunks written to the output in bytes
+ * @return bool Wether compiling was successfull
+ */
+static bool render(
+    String inPath,
+    Print &out,
+    GPIOSnapshot &gpios,
+    size_t chunkSize
+) {
+    // Compile the source if there is no up to date program, the memory of
+    // the compile is released before the page is rendered
+    Program program = Program();
+    bool loaded = loadProgram(inPath, program);
+
+    // The many small writes are collected into whole chunks,
+    // the rest is written when the emitter is destroyed
+    Emitter emitter = Emitter(out, chunkSize);
+
+    // Sources that can't be compiled are parsed every time
+    if (!loaded || program.isInterpreted()) {
+        // The strings and vectors of the Parser are released at once
+        ArenaScope arena = ArenaScope();
+
+        Parser parser = Parser(inPath, emitter, gpios);
+
+        return parser.parse();
+    }
+
+    // Render the program, unless the page is cached
+    return outputCache.render(inPath, program, emitter, gpios);
+}
 
 bool aalec_pug(String inPath, String outPath) {
     File inFile = LittleFS.open(inPath, "r");
@@ -14,12 +83,215 @@ bool aalec_pug(String inPath, String outPath) {
 
     // Infile doesn't exist
     if (!inFile.isFile()) {
-        return -1;
+        return false;
+    }
+
+    inFile.close();
+
+    // Open the output file
+    File outFile = LittleFS.open(outPath, "w");
+    if (!outFile) {
+        Serial.printf_P(
+            PSTR("Error 2-1: Failed to open file for writing '%s'\n"),
+            outPath.c_str()
+        );
+        return false;
+    }
+
+    // Compile into the output file, in whole pages of the file system
+    GPIOSnapshot gpios = GPIOSnapshot(gpioSampler);
+    bool success = render(inPath, outFile, gpios, AALEC_PUG_FILE_CHUNK_SIZE);
+    outFile.close();
+
+    return success;
+}
+
+bool aalec_pug(String inPath, Print &out) {
+    // Each GPIO is read at most once per call, including the included files.
+    // GPIOs that are sampled in the background aren't read at all
+    GPIOSnapshot gpios = GPIOSnapshot(gpioSampler);
+
+    return aalec_pug(inPath, out, gpios);
+}
+
+bool aalec_pug(String inPath, Print &out, GPIOSnapshot &gpios) {
+    File inFile = LittleFS.open(inPath, "r");
+
+    // Infile doesn't exist
+    if (!inFile.isFile()) {
+        return false;
+    }
+
+    inFile.close();
+
+    return render(inPath, out, gpios, AALEC_PUG_OUTPUT_CHUNK_SIZE);
+}
+
+bool aalec_pug(String inPath, StreamString &out) {
+    return aalec_pug(inPath, (Print &)out);
+}
+
+uint32_t aalec_pug_gpio_reads() {
+    return GPIOSnapshot::reads();
+}
+
+uint32_t aalec_pug_gpio_reads_avoided() {
+    return GPIOSnapshot::avoidedReads();
+}
+
+uint32_t aalec_pug_output_writes() {
+    return Emitter::writes();
+}
+
+uint32_t aalec_pug_output_bytes() {
+    return Emitter::bytes();
+}
+
+bool aalec_pug_gpios(String inPath, u16 &gpios) {
+    File inFile = LittleFS.open(inPath, "r");
+
+    // Infile doesn't exist
+    if (!inFile.isFile()) {
+        return false;
     }
 
     inFile.close();
 
-    Parser parser = Parser(inPath, outPath);
+    Program program = Program();
+    if (!loadProgram(inPath, program)) {
+        return false;
+    }
+
+    gpios = program.gpios();
+
+    return true;
+}
+
+void aalec_pug_tag_values(bool tagValues) {
+    Parser::setTagValues(tagValues);
+}
+
+bool aalec_pug_values(String inPath, Print &out) {
+    File inFile = LittleFS.open(inPath, "r");
+
+    // Infile doesn't exist
+    if (!inFile.isFile()) {
+        return false;
+    }
+
+    inFile.close();
+
+    Program program = Program();
+    if (!loadProgram(inPath, program)) {
+        return false;
+    }
+    u16 dependencies = program.gpios();
+    u16 decisions = program.decisionGpios();
+
+    // Each GPIO is read at most once, sampled GPIOs aren't read at all
+    GPIOSnapshot gpios = GPIOSnapshot(gpioSampler);
+
+    out.print('{');
+    bool first = true;
+    for (size_t i = 1; i < AALEC_PUG_CACHE_GPIO_COUNT; i++) {
+        if (dependencies & gpioBit((GPIOId)i)) {
+            out.printf_P(
+                PSTR("%s\"%s\":%u"),
+                first ? "" : ",",
+                gpioKey((GPIOId)i),
+                (unsigned int)gpios.read((GPIOId)i)
+            );
+            first = false;
+        }
+    }
+
+    // The values that decide which parts are shown, the page can't be
+    // updated in place when one of them changes
+    out.printf_P(PSTR("%s\"reload\":["), first ? "" : ",");
+    first = true;
+    for (size_t i = 1; i < AALEC_PUG_CACHE_GPIO_COUNT; i++) {
+        if (dependencies & decisions & gpioBit((GPIOId)i)) {
+            out.printf_P(
+                PSTR("%s\"%s\""),
+                first ? "" : ",",
+                gpioKey((GPIOId)i)
+            );
+            first = false;
+        }
+    }
+    out.print(F("]}"));
+
+    return true;
+}
+
+bool aalec_pug_etag(String inPath, GPIOSnapshot &gpios, String &etag) {
+    File inFile = LittleFS.open(inPath, "r");
+
+    // Infile doesn't exist
+    if (!inFile.isFile()) {
+        return false;
+    }
+
+    inFile.close();
+
+    // Sources that can't be compiled use every GPIO, they have no tag
+    Program program = Program();
+    if (!loadProgram(inPath, program) || program.isInterpreted()) {
+        return false;
+    }
+
+    ETag tag = ETag();
+
+    // The version of the library and of the programs, an update might render
+    // the same source differently
+    tag.add(
+        (const uint8_t *)AALEC_PUG_VERSION,
+        sizeof(AALEC_PUG_VERSION) - 1
+    );
+    tag.add((u32)AALEC_PUG_PROGRAM_VERSION);
+
+    // The version of the source and the included files
+    for (const Dependency &dependency : program.dependencies()) {
+        tag.add(dependency.path);
+        tag.add(dependency.size);
+        tag.add(dependency.lastWrite);
+    }
+
+    // The markup of the values
+    tag.add((u32)Parser::tagValues());
+
+    // The values of the used GPIOs
+    u16 dependencies = program.gpios();
+    tag.add(dependencies);
+    for (size_t i = 1; i < AALEC_PUG_CACHE_GPIO_COUNT; i++) {
+        if (dependencies & gpioBit((GPIOId)i)) {
+            tag.add(gpios.read((GPIOId)i));
+
+            // A cached page might show a rounded value
+            if (outputCache.isQuantized((GPIOId)i)) {
+                tag.setWeak();
+            }
+        }
+    }
+
+    etag = tag.toString();
+
+    return true;
+}
+
+bool aalec_pug_file_etag(String path, String &etag) {
+    File file = LittleFS.open(path, "r");
+
+    if (!file.isFile()) {
+        return false;
+    }
+
+    ETag tag = ETag();
+    tag.add((u32)file.size());
+    tag.add((u32)file.getLastWrite());
+    file.close();
+
+    etag = tag.toString();
 
-    return parser.parse();
+    return true;
 }
@@ -2,9 +2,22 @@
 #define AALEC_PUG_H
 
 #include <Arduino.h>
+#include <StreamString.h>
+#include <arena/arena.h>
+#include <cache/cache.h>
+#include <gpio/gpio.h>
 
 /**
- * @brief Compiles a given pug file
+ * @brief Version of the library, matches `library.properties`.
+ *        Part of the ETags, so pages are loaded again after an update
+ */
+#define AALEC_PUG_VERSION "1.0.0"
+
+/**
+ * @brief Compiles a given pug file into a file.
+ *        The source is compiled once into a program next to it (inPath + ".prg"),
+ *        which is rendered with the current GPIO values on every call.
+ *        The program is compiled again when the source or an included pug file changes
  *
  * @param inPath Path to the pug file
  * @param outPath Path to the output file (optional), default is inPath + ".html"
@@ -13,4 +26,139 @@
  */
 bool aalec_pug(String inPath, String outPath = "");
 
+/**
+ * @brief Compiles a given pug file and writes the HTML directly to the given output,
+ *        for example a HTTP response, a StreamString or a buffer in RAM.
+ *        Works like `aalec_pug(String, String)` without writing to the file system.
+ *        The output might be incomplete if compiling was unsuccessfull
+ *
+ * @param inPath Path to the pug file
+ * @param out Where the HTML is written to
+ * @return true Compiling was successfull
+ * @return false Compiling was unsuccessfull, see serial output for details
+ */
+bool aalec_pug(String inPath, Print &out);
+
+/**
+ * @brief Compiles a given pug file with the given GPIO values,
+ *        see `aalec_pug(String, Print &)`.
+ *        Use the snapshot of `aalec_pug_etag()`, so the HTML matches the ETag
+ *
+ * @param inPath Path to the pug file
+ * @param out Where the HTML is written to
+ * @param gpios The GPIO values, GPIOs that weren't read yet are read on their first use
+ * @return true Compiling was successfull
+ * @return false Compiling was unsuccessfull, see serial output for details
+ */
+bool aalec_pug(String inPath, Print &out, GPIOSnapshot &gpios);
+
+/**
+ * @brief Compiles a given pug file into a StreamString,
+ *        see `aalec_pug(String, Print &)`.
+ *        A StreamString is a String and a Print, so this picks the Print
+ *
+ * @param inPath Path to the pug file
+ * @param out The StreamString the HTML is appended to
+ * @return true Compiling was successfull
+ * @return false Compiling was unsuccessfull, see serial output for details
+ */
+bool aalec_pug(String inPath, StreamString &out);
+
+/**
+ * @brief Amount of GPIO reads of all calls.
+ *        Each GPIO is read at most once per call
+ *
+ * @return uint32_t The amount
+ */
+uint32_t aalec_pug_gpio_reads();
+
+/**
+ * @brief Amount of GPIO uses of all calls that didn't read the GPIO again,
+ *        because it was already read in the same call
+ *
+ * @return uint32_t The amount
+ */
+uint32_t aalec_pug_gpio_reads_avoided();
+
+/**
+ * @brief Amount of writes to the outputs of all calls.
+ *        The HTML is written in chunks of `AALEC_PUG_OUTPUT_CHUNK_SIZE` bytes,
+ *        or `AALEC_PUG_FILE_CHUNK_SIZE` bytes for files
+ *
+ * @return uint32_t The amount
+ */
+uint32_t aalec_pug_output_writes();
+
+/**
+ * @brief Amount of bytes written to the outputs of all calls,
+ *        divided by `aalec_pug_output_writes()` it is the size of an average write
+ *
+ * @return uint32_t The amount
+ */
+uint32_t aalec_pug_output_bytes();
+
+/**
+ * @brief Get the GPIOs a pug file and its included files read,
+ *        compiles the pug file if needed.
+ *        Samplers, caches and servers can use it to only care about these GPIOs
+ *
+ * @param inPath Path to the pug file
+ * @param gpios Set to the bit mask of the GPIOIds, `gpioBit(GPIOId::Temp)` for
+ *              `IO_TEMP`. All bits are set if the source is too large to be compiled
+ * @return true Getting the GPIOs was successfull
+ * @return false Getting the GPIOs was unsuccessfull, see serial output for details
+ */
+bool aalec_pug_gpios(String inPath, u16 &gpios);
+
+/**
+ * @brief Set wether GPIO values in the text of pages are wrapped in
+ *        `<span data-io="IO_TEMP">`, so they can be updated with `aalec_pug_values()`
+ *        instead of loading the whole page again. Pug files are compiled again
+ *        after it changed
+ *
+ * @param tagValues Wether the values are wrapped, defaults to false
+ */
+void aalec_pug_tag_values(bool tagValues);
+
+/**
+ * @brief Write the current values of the GPIOs a pug file and its included files use
+ *        as JSON object, keyed like the `data-io` attributes. `reload` lists the values
+ *        expressions read, the page must be loaded again when one of them changes,
+ *        eg: {"IO_TEMP":21,"IO_BUTTON":1,"reload":["IO_BUTTON"]}.
+ *        Compiles the pug file if needed, but doesn't render it
+ *
+ * @param inPath Path to the pug file
+ * @param out Where the JSON is written to
+ * @return true Writing the values was successfull
+ * @return false Writing the values was unsuccessfull, see serial output for details
+ */
+bool aalec_pug_values(String inPath, Print &out);
+
+/**
+ * @brief Get the HTTP entity tag of the page of a pug file without rendering it,
+ *        compiles the pug file if needed.
+ *        The tag changes when the source, an included file or a GPIO the page
+ *        uses changes. It is weak if the output cache rounds one of the GPIOs
+ *
+ * @param inPath Path to the pug file
+ * @param gpios The GPIO values, the used GPIOs are read into it.
+ *              Render the page with it, see `aalec_pug(String, Print &, GPIOSnapshot &)`
+ * @param etag Set to the tag, eg: "1a2b3c4d"
+ * @return true There is a tag
+ * @return false There is no tag, because the pug file doesn't exist, can't be
+ *               compiled, or is too large to be compiled
+ */
+bool aalec_pug_etag(String inPath, GPIOSnapshot &gpios, String &etag);
+
+/**
+ * @brief Get the HTTP entity tag of a file from its size and the time of its last write,
+ *        without reading it
+ *
+ * @param path Path to the file
+ * @param etag Set to the tag, eg: "1a2b3c4d"
+ * @return true There is a tag
+ * @return false The file doesn't exist
+ */
+bool aalec_pug_file_etag(String path, String &etag);
+
 #endif  // AALEC_PUG_H
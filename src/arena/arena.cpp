@@ -0,0 +1,192 @@
+#include "arena.h"
+
+#include <algorithm>
+
+Arena compileArena = Arena();
+
+Arena::Arena() :
+    buffer_(nullptr),
+    bufferSize_(0),
+    blocks_(nullptr),
+    current_(nullptr),
+    left_(0),
+    heapChunks_(nullptr),
+    free_(),
+    scopes_(0),
+    used_(0),
+    peak_(0) {}
+
+void Arena::setBuffer(uint8_t *buffer, size_t size) {
+    if (scopes_ > 0) {
+        return;
+    }
+
+    // Chunks start at the alignment
+    size_t skip = buffer != nullptr
+        ? (AALEC_PUG_ARENA_ALIGNMENT
+           - (uintptr_t)buffer % AALEC_PUG_ARENA_ALIGNMENT)
+            % AALEC_PUG_ARENA_ALIGNMENT
+        : 0;
+
+    if (buffer == nullptr || size <= skip) {
+        buffer_ = nullptr;
+        bufferSize_ = 0;
+    } else {
+        buffer_ = buffer + skip;
+        bufferSize_ = size - skip;
+    }
+
+    release();
+}
+
+bool Arena::isActive() {
+    return scopes_ > 0;
+}
+
+void *Arena::allocate(size_t size) {
+    size_t sizeClass = Arena::sizeClass(size);
+    if (sizeClass >= AALEC_PUG_ARENA_CLASSES) {
+        return nullptr;
+    }
+    size_t chunkSize = (size_t)AALEC_PUG_ARENA_ALIGNMENT << sizeClass;
+
+    // Reuse a freed chunk
+    void *chunk = free_[sizeClass];
+    if (chunk != nullptr) {
+        free_[sizeClass] = *(void **)chunk;
+    } else if (chunkSize <= left_) {
+        // Take it from the current block
+        chunk = current_;
+        current_ += chunkSize;
+        left_ -= chunkSize;
+    } else {
+        // Get a new block, large chunks get a block of their own
+        size_t blockSize = AALEC_PUG_ARENA_ALIGNMENT
+            + std::max(chunkSize, (size_t)AALEC_PUG_ARENA_BLOCK_SIZE);
+        uint8_t *block = (uint8_t *)malloc(blockSize);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        *(void **)block = blocks_;
+        blocks_ = block;
+
+        chunk = block + AALEC_PUG_ARENA_ALIGNMENT;
+        if (chunkSize < AALEC_PUG_ARENA_BLOCK_SIZE) {
+            keepRest();
+            current_ = (uint8_t *)chunk + chunkSize;
+            left_ = blockSize - AALEC_PUG_ARENA_ALIGNMENT - chunkSize;
+        }
+    }
+
+    used_ += chunkSize;
+    peak_ = std::max(peak_, used_);
+
+    return chunk;
+}
+
+void *Arena::allocateFromHeap(size_t size) {
+    // The chunk follows the pointer to the next one
+    uint8_t *chunk =
+        (uint8_t *)::operator new(AALEC_PUG_ARENA_ALIGNMENT + size);
+    *(void **)chunk = heapChunks_;
+    heapChunks_ = chunk;
+
+    return chunk + AALEC_PUG_ARENA_ALIGNMENT;
+}
+
+void Arena::deallocate(void *chunk, size_t size) {
+    if (chunk == nullptr) {
+        return;
+    }
+
+    // Chunks from the heap only exist after the arena had none
+    void **link = &heapChunks_;
+    while (*link != nullptr) {
+        uint8_t *heapChunk = (uint8_t *)*link;
+        if (heapChunk + AALEC_PUG_ARENA_ALIGNMENT == chunk) {
+            *link = *(void **)heapChunk;
+            ::operator delete(heapChunk);
+            return;
+        }
+        link = (void **)heapChunk;
+    }
+
+    size_t sizeClass = Arena::sizeClass(size);
+    *(void **)chunk = free_[sizeClass];
+    free_[sizeClass] = chunk;
+    used_ -= (size_t)AALEC_PUG_ARENA_ALIGNMENT << sizeClass;
+}
+
+void Arena::begin() {
+    scopes_++;
+}
+
+void Arena::end() {
+    if (scopes_ > 0 && --scopes_ == 0) {
+        release();
+    }
+}
+
+size_t Arena::used() {
+    return used_;
+}
+
+size_t Arena::peak() {
+    return peak_;
+}
+
+size_t Arena::sizeClass(size_t size) {
+    size_t sizeClass = 0;
+    while (((size_t)AALEC_PUG_ARENA_ALIGNMENT << sizeClass) < size) {
+        sizeClass++;
+    }
+
+    return sizeClass;
+}
+
+void Arena::keepRest() {
+    // Split the rest into the largest chunks that fit, it stays aligned
+    while (left_ >= AALEC_PUG_ARENA_ALIGNMENT) {
+        size_t sizeClass = Arena::sizeClass(left_);
+        if (((size_t)AALEC_PUG_ARENA_ALIGNMENT << sizeClass) > left_) {
+            sizeClass--;
+        }
+        size_t chunkSize = (size_t)AALEC_PUG_ARENA_ALIGNMENT << sizeClass;
+
+        *(void **)current_ = free_[sizeClass];
+        free_[sizeClass] = current_;
+        current_ += chunkSize;
+        left_ -= chunkSize;
+    }
+}
+
+void Arena::release() {
+    while (blocks_ != nullptr) {
+        void *next = *(void **)blocks_;
+        free(blocks_);
+        blocks_ = next;
+    }
+
+    while (heapChunks_ != nullptr) {
+        void *next = *(void **)heapChunks_;
+        ::operator delete(heapChunks_);
+        heapChunks_ = next;
+    }
+
+    for (size_t i = 0; i < AALEC_PUG_ARENA_CLASSES; i++) {
+        free_[i] = nullptr;
+    }
+
+    // Start with the buffer again
+    current_ = buffer_;
+    left_ = bufferSize_ - bufferSize_ % AALEC_PUG_ARENA_ALIGNMENT;
+    used_ = 0;
+}
+
+ArenaScope::ArenaScope() {
+    compileArena.begin();
+}
+
+ArenaScope::~ArenaScope() {
+    compileArena.end();
+}
@@ -0,0 +1,301 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <Arduino.h>
+
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Size of the blocks the arena gets from the heap in bytes.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_ARENA_BLOCK_SIZE
+    #define AALEC_PUG_ARENA_BLOCK_SIZE 1024
+#endif
+
+/**
+ * @brief Alignment of the chunks and size of the smallest chunk in bytes
+ */
+#define AALEC_PUG_ARENA_ALIGNMENT 8
+
+/**
+ * @brief Amount of chunk sizes, chunks of class i have `8 << i` bytes
+ */
+#define AALEC_PUG_ARENA_CLASSES 24
+
+/**
+ * @brief Memory for the strings and vectors of one compile.
+ *        Chunks are taken from a user provided buffer or from blocks of the heap,
+ *        freed chunks are reused by chunks of the same size.
+ *        Everything is released at once when the last `ArenaScope` ends,
+ *        so compiles leave the heap as they found it
+ */
+class Arena {
+   private:
+    /**
+     * @brief The user provided buffer, nullptr if there is none
+     */
+    uint8_t *buffer_;
+
+    /**
+     * @brief Size of the user provided buffer in bytes
+     */
+    size_t bufferSize_;
+
+    /**
+     * @brief The blocks from the heap, each starts with a pointer to the next one
+     */
+    void *blocks_;
+
+    /**
+     * @brief Start of the memory that wasn't used yet in the current block
+     */
+    uint8_t *current_;
+
+    /**
+     * @brief Bytes that weren't used yet in the current block
+     */
+    size_t left_;
+
+    /**
+     * @brief Chunks from `::operator new` when the arena had none,
+     *        each starts with a pointer to the next one
+     */
+    void *heapChunks_;
+
+    /**
+     * @brief Freed chunks of each size, each starts with a pointer to the next one
+     */
+    void *free_[AALEC_PUG_ARENA_CLASSES];
+
+    /**
+     * @brief Amount of active `ArenaScope`s
+     */
+    int scopes_;
+
+    /**
+     * @brief Bytes of the chunks that are in use
+     */
+    size_t used_;
+
+    /**
+     * @brief Most bytes of chunks that were in use at once
+     */
+    size_t peak_;
+
+   public:
+    /**
+     * @brief Construct a new Arena object without a buffer
+     */
+    Arena();
+
+    /**
+     * @brief Set the buffer that is used before any block of the heap.
+     *        Only takes effect while no `ArenaScope` is active
+     *
+     * @param buffer The buffer, must stay valid while it is set, nullptr to remove it
+     * @param size Size of the buffer in bytes
+     */
+    void setBuffer(uint8_t *buffer, size_t size);
+
+    /**
+     * @brief Checks if an `ArenaScope` is active
+     *
+     * @return bool Wether new strings and vectors use the arena
+     */
+    bool isActive();
+
+    /**
+     * @brief Get a chunk of memory
+     *
+     * @param size Size of the chunk in bytes
+     * @return void* The chunk, nullptr if the heap is full
+     */
+    void *allocate(size_t size);
+
+    /**
+     * @brief Get a chunk from `::operator new` when `allocate()` had none.
+     *        It is given back with `deallocate()` or released with the arena
+     *
+     * @param size Size of the chunk in bytes
+     * @return void* The chunk
+     */
+    void *allocateFromHeap(size_t size);
+
+    /**
+     * @brief Give a chunk back, so it can be reused
+     *
+     * @param chunk The chunk
+     * @param size Size of the chunk in bytes, as given to `allocate()`
+     */
+    void deallocate(void *chunk, size_t size);
+
+    /**
+     * @brief Start using the arena, see `ArenaScope`
+     */
+    void begin();
+
+    /**
+     * @brief Stop using the arena, releases everything after the last call
+     */
+    void end();
+
+    /**
+     * @brief Memory of the chunks that are in use
+     *
+     * @return size_t The size in bytes
+     */
+    size_t used();
+
+    /**
+     * @brief Most memory the chunks used at once, for sizing the buffer
+     *
+     * @return size_t The size in bytes
+     */
+    size_t peak();
+
+   private:
+    /**
+     * @brief The class of the smallest chunk that fits a size
+     *
+     * @param size The size in bytes
+     * @return size_t The class, chunks have `8 << class` bytes
+     */
+    static size_t sizeClass(size_t size);
+
+    /**
+     * @brief Keep the rest of the current block as freed chunks
+     */
+    void keepRest();
+
+    /**
+     * @brief Free all blocks and forget all chunks
+     */
+    void release();
+};
+
+/**
+ * @brief The arena that is used by all compiles and renders.
+ *        Uses blocks of the heap until a buffer is set
+ */
+extern Arena compileArena;
+
+/**
+ * @brief Uses `compileArena` for the strings and vectors of the Scanner and Parser
+ *        that are created while it exists. Scopes can be nested
+ */
+class ArenaScope {
+   public:
+    /**
+     * @brief Construct a new ArenaScope object and start using the arena
+     */
+    ArenaScope();
+
+    /**
+     * @brief Destroy the ArenaScope object, the arena is released with the last scope
+     */
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope &scope) = delete;
+
+    ArenaScope &operator=(const ArenaScope &scope) = delete;
+};
+
+/**
+ * @brief Allocator for containers that uses `compileArena` if it was active
+ *        when the container was created, otherwise the heap
+ *
+ * @tparam T The type of the elements
+ */
+template <typename T>
+class ArenaAllocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    /**
+     * @brief The arena, nullptr for the heap
+     */
+    Arena *arena;
+
+    /**
+     * @brief Construct a new ArenaAllocator object for the active arena
+     */
+    ArenaAllocator() :
+        arena(compileArena.isActive() ? &compileArena : nullptr) {}
+
+    /**
+     * @brief Construct a new ArenaAllocator object with the arena of another one
+     *
+     * @param allocator The other allocator
+     */
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &allocator) :
+        arena(allocator.arena) {}
+
+    /**
+     * @brief Get memory for elements. Throws `std::bad_alloc` if the arena
+     *        has none and exceptions are enabled, uses the heap otherwise
+     *
+     * @param count Amount of elements
+     * @return T* The memory
+     */
+    T *allocate(size_t count) {
+        if (arena != nullptr) {
+            void *elements = arena->allocate(count * sizeof(T));
+            if (elements == nullptr) {
+#if defined(__cpp_exceptions)
+                throw std::bad_alloc();
+#else
+                elements = arena->allocateFromHeap(count * sizeof(T));
+#endif
+            }
+
+            return (T *)elements;
+        }
+
+        return (T *)::operator new(count * sizeof(T));
+    }
+
+    /**
+     * @brief Give memory of elements back
+     *
+     * @param elements The memory
+     * @param count Amount of elements, as given to `allocate()`
+     */
+    void deallocate(T *elements, size_t count) {
+        if (arena != nullptr) {
+            arena->deallocate(elements, count * sizeof(T));
+        } else {
+            ::operator delete(elements);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &allocator) const {
+        return arena == allocator.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &allocator) const {
+        return arena != allocator.arena;
+    }
+};
+
+/**
+ * @brief A vector in the arena, see `ArenaAllocator`
+ */
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/**
+ * @brief A string in the arena, see `ArenaAllocator`.
+ *        Short strings are stored in the object itself
+ */
+using ArenaString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+#endif  // ARENA_H
@@ -0,0 +1,207 @@
+#include "cache.h"
+
+#include <algorithm>
+
+Quantization::Quantization() :
+    step(0),
+    hysteresis(0),
+    last(0),
+    hasLast(false) {}
+
+u32 Quantization::apply(u32 value) {
+    if (step <= 1) {
+        return value;
+    }
+
+    u32 current = value / step;
+
+    // Stay in the previous step while the value is close enough to it
+    if (hasLast && current != last) {
+        uint64_t low = (uint64_t)last * step;
+        uint64_t high = low + step - 1;
+        if ((uint64_t)value + hysteresis >= low
+            && value <= high + hysteresis) {
+            current = last;
+        }
+    }
+
+    last = current;
+    hasLast = true;
+
+    return current;
+}
+
+CacheEntry::CacheEntry() :
+    path(),
+    key(std::vector<u32>()),
+    html(std::vector<uint8_t>()),
+    lastUse(0) {}
+
+size_t CacheEntry::size() const {
+    return sizeof(CacheEntry) + path.length() + key.size() * sizeof(u32)
+        + html.size();
+}
+
+CacheOutput::CacheOutput(
+    Print &out,
+    std::vector<uint8_t> &copy,
+    size_t limit
+) :
+    out_(out),
+    copy_(copy),
+    limit_(limit),
+    overflowed_(false) {}
+
+bool CacheOutput::overflowed() {
+    return overflowed_;
+}
+
+size_t CacheOutput::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t CacheOutput::write(const uint8_t *buffer, size_t size) {
+    // Stop copying pages that don't fit into the cache anyway
+    if (!overflowed_) {
+        size_t needed = copy_.size() + size;
+        if (needed > limit_) {
+            overflowed_ = true;
+            copy_ = std::vector<uint8_t>();
+        } else {
+            // Grow like the vector would, but never beyond the limit
+            if (needed > copy_.capacity()) {
+                copy_.reserve(std::min(
+                    limit_,
+                    std::max(needed, copy_.capacity() * 2)
+                ));
+            }
+            copy_.insert(copy_.end(), buffer, buffer + size);
+        }
+    }
+
+    return out_.write(buffer, size);
+}
+
+OutputCache outputCache = OutputCache();
+
+OutputCache::OutputCache() :
+    budget_(0),
+    size_(0),
+    entries_(std::vector<CacheEntry>()),
+    quantizations_(),
+    uses_(0),
+    hits_(0),
+    misses_(0) {}
+
+void OutputCache::setBudget(size_t budget) {
+    budget_ = budget;
+    evict(0);
+}
+
+void OutputCache::setQuantization(GPIOId id, u32 step, u32 hysteresis) {
+    if ((size_t)id >= AALEC_PUG_CACHE_GPIO_COUNT) {
+        return;
+    }
+
+    Quantization &quantization = quantizations_[(size_t)id];
+    quantization.step = step;
+    quantization.hysteresis = hysteresis;
+    quantization.hasLast = false;
+}
+
+bool OutputCache::isQuantized(GPIOId id) {
+    return budget_ > 0 && (size_t)id < AALEC_PUG_CACHE_GPIO_COUNT
+        && quantizations_[(size_t)id].step > 1;
+}
+
+bool OutputCache::render(
+    String path,
+    Program &program,
+    Print &out,
+    GPIOSnapshot &gpios
+) {
+    if (budget_ == 0) {
+        return program.render(out, gpios);
+    }
+
+    // The key are the rounded values of the GPIOs the page depends on.
+    // The values stay in the snapshot, so a new page is rendered with them
+    CacheEntry entry = CacheEntry();
+    entry.path = path;
+    u16 dependencies = program.gpios();
+    for (size_t i = 1; i < AALEC_PUG_CACHE_GPIO_COUNT; i++) {
+        if (dependencies & gpioBit((GPIOId)i)) {
+            u32 value = gpios.read((GPIOId)i);
+            entry.key.push_back(quantizations_[i].apply(value));
+        }
+    }
+
+    // Write the cached page
+    uses_++;
+    for (CacheEntry &cached : entries_) {
+        if (cached.path == path && cached.key == entry.key) {
+            cached.lastUse = uses_;
+            hits_++;
+            if (!cached.html.empty()) {
+                out.write(cached.html.data(), cached.html.size());
+            }
+            return true;
+        }
+    }
+    misses_++;
+
+    // Render the page and keep it if it fits into the budget
+    size_t limit = budget_ > entry.size() ? budget_ - entry.size() : 0;
+    CacheOutput cacheOutput = CacheOutput(out, entry.html, limit);
+    if (!program.render(cacheOutput, gpios)) {
+        return false;
+    }
+
+    if (!cacheOutput.overflowed() && entry.size() <= budget_) {
+        entry.html.shrink_to_fit();
+        evict(entry.size());
+        entry.lastUse = uses_;
+        size_ += entry.size();
+        entries_.push_back(std::move(entry));
+    }
+
+    return true;
+}
+
+void OutputCache::remove(String path) {
+    for (size_t i = 0; i < entries_.size();) {
+        if (entries_[i].path == path) {
+            size_ -= entries_[i].size();
+            entries_.erase(entries_.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+size_t OutputCache::size() {
+    return size_;
+}
+
+uint32_t OutputCache::hits() {
+    return hits_;
+}
+
+uint32_t OutputCache::misses() {
+    return misses_;
+}
+
+void OutputCache::evict(size_t size) {
+    while (!entries_.empty() && size_ + size > budget_) {
+        // Find the least recently used page
+        size_t oldest = 0;
+        for (size_t i = 1; i < entries_.size(); i++) {
+            if (entries_[i].lastUse < entries_[oldest].lastUse) {
+                oldest = i;
+            }
+        }
+
+        size_ -= entries_[oldest].size();
+        entries_.erase(entries_.begin() + oldest);
+    }
+}
@@ -0,0 +1,264 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <program/program.h>
+
+/**
+ * @brief Amount of GPIOIds a page can depend on, the hardware GPIOs and their ages
+ */
+#define AALEC_PUG_CACHE_GPIO_COUNT ((size_t)GPIOId::HumidityAge + 1)
+
+/**
+ * @brief How the values of a GPIO are rounded for the key of a cached page
+ */
+class Quantization {
+   public:
+    /**
+     * @brief Size of the steps values are rounded down to, 0 or 1 to use the exact value
+     */
+    u32 step;
+
+    /**
+     * @brief How far a value may leave the step of the previous value
+     *        before it counts as the next step
+     */
+    u32 hysteresis;
+
+    /**
+     * @brief The step of the previous value
+     */
+    u32 last;
+
+    /**
+     * @brief Wether there is a previous value
+     */
+    bool hasLast;
+
+    /**
+     * @brief Construct a new Quantization object that uses the exact values
+     */
+    Quantization();
+
+    /**
+     * @brief Round a value to its step
+     *
+     * @param value The value
+     * @return u32 The step
+     */
+    u32 apply(u32 value);
+};
+
+/**
+ * @brief A rendered page
+ */
+class CacheEntry {
+   public:
+    /**
+     * @brief Path to the pug file
+     */
+    String path;
+
+    /**
+     * @brief The rounded values of the GPIOs the page depends on, in the order of the GPIOIds
+     */
+    std::vector<u32> key;
+
+    /**
+     * @brief The HTML
+     */
+    std::vector<uint8_t> html;
+
+    /**
+     * @brief When the entry was used last, see `OutputCache::uses_`
+     */
+    uint32_t lastUse;
+
+    /**
+     * @brief Construct a new empty CacheEntry object
+     */
+    CacheEntry();
+
+    /**
+     * @brief Memory used by the entry in bytes
+     *
+     * @return size_t The size
+     */
+    size_t size() const;
+};
+
+/**
+ * @brief Writes the HTML to an output and keeps a copy of it
+ */
+class CacheOutput : public Print {
+   private:
+    /**
+     * @brief The output
+     */
+    Print &out_;
+
+    /**
+     * @brief The copy, cleared when it gets larger than `limit_`
+     */
+    std::vector<uint8_t> &copy_;
+
+    /**
+     * @brief Maximum size of the copy in bytes
+     */
+    size_t limit_;
+
+    /**
+     * @brief Wether the copy got too large
+     */
+    bool overflowed_;
+
+   public:
+    /**
+     * @brief Construct a new CacheOutput object
+     *
+     * @param out The output
+     * @param copy The copy
+     * @param limit Maximum size of the copy in bytes
+     */
+    CacheOutput(Print &out, std::vector<uint8_t> &copy, size_t limit);
+
+    /**
+     * @brief Checks if the copy got too large
+     *
+     * @return bool Wether the copy is incomplete
+     */
+    bool overflowed();
+
+    size_t write(uint8_t value) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+/**
+ * @brief Keeps rendered pages in RAM. A page is rendered again only if one of
+ *        the GPIOs it depends on changed, a cache hit just writes the stored HTML.
+ *        Least recently used pages are removed when the budget is exceeded
+ */
+class OutputCache {
+   private:
+    /**
+     * @brief Maximum memory used by the pages in bytes, 0 disables the cache
+     */
+    size_t budget_;
+
+    /**
+     * @brief Memory used by the pages in bytes
+     */
+    size_t size_;
+
+    /**
+     * @brief The pages
+     */
+    std::vector<CacheEntry> entries_;
+
+    /**
+     * @brief How the values of each GPIO are rounded, indexed by the GPIOId
+     */
+    Quantization quantizations_[AALEC_PUG_CACHE_GPIO_COUNT];
+
+    /**
+     * @brief Counts the uses of pages, for finding the least recently used one
+     */
+    uint32_t uses_;
+
+    /**
+     * @brief Amount of renders that were answered by the cache
+     */
+    uint32_t hits_;
+
+    /**
+     * @brief Amount of renders that weren't answered by the cache
+     */
+    uint32_t misses_;
+
+   public:
+    /**
+     * @brief Construct a new disabled OutputCache object
+     */
+    OutputCache();
+
+    /**
+     * @brief Set the maximum memory used by the pages, removes pages if needed
+     *
+     * @param budget The budget in bytes, 0 disables the cache and removes all pages
+     */
+    void setBudget(size_t budget);
+
+    /**
+     * @brief Round the values of a GPIO, so small changes still use the cached page.
+     *        With step 10, values 0 to 9 use the same page, 10 to 19 the next one.
+     *        With hysteresis 2 a value has to be below 8 or above 21 to leave 10 to 19
+     *
+     * @param id The GPIO ID
+     * @param step Size of the steps values are rounded down to, 0 to use the exact value
+     * @param hysteresis How far a value may leave the previous step, defaults to 0
+     */
+    void setQuantization(GPIOId id, u32 step, u32 hysteresis = 0);
+
+    /**
+     * @brief Checks if cached pages may show rounded values of a GPIO
+     *
+     * @param id The GPIO ID
+     * @return bool Wether the cache is enabled and rounds the values of the GPIO
+     */
+    bool isQuantized(GPIOId id);
+
+    /**
+     * @brief Render a program or write the cached page
+     *
+     * @param path Path to the pug file
+     * @param program The program of the pug file
+     * @param out Where the HTML is written to
+     * @param gpios The GPIO values of the render
+     * @return bool Wheter rendering was successful, see serial output for errors
+     */
+    bool render(String path, Program &program, Print &out, GPIOSnapshot &gpios);
+
+    /**
+     * @brief Remove all pages of a pug file, for example after it changed
+     *
+     * @param path Path to the pug file
+     */
+    void remove(String path);
+
+    /**
+     * @brief Memory used by the pages
+     *
+     * @return size_t The size in bytes
+     */
+    size_t size();
+
+    /**
+     * @brief Amount of renders that were answered by the cache
+     *
+     * @return uint32_t The amount
+     */
+    uint32_t hits();
+
+    /**
+     * @brief Amount of renders that weren't answered by the cache
+     *
+     * @return uint32_t The amount
+     */
+    uint32_t misses();
+
+   private:
+    /**
+     * @brief Remove least recently used pages until the given size fits into the budget
+     *
+     * @param size The size in bytes that should fit in addition to the pages
+     */
+    void evict(size_t size);
+};
+
+/**
+ * @brief The cache that is used by all renders.
+ *        Disabled until a budget is set
+ */
+extern OutputCache outputCache;
+
+#endif  // CACHE_H
@@ -0,0 +1,507 @@
+#include "compiler.h"
+
+#include <algorithm>
+
+CompilerOutput::CompilerOutput(Compiler &compiler) : compiler_(compiler) {}
+
+size_t CompilerOutput::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t CompilerOutput::write(const uint8_t *buffer, size_t size) {
+    compiler_.append(Op::Static, buffer, size);
+    return size;
+}
+
+CompilerLog::CompilerLog(Compiler &compiler) : compiler_(compiler) {}
+
+size_t CompilerLog::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t CompilerLog::write(const uint8_t *buffer, size_t size) {
+    compiler_.append(Op::Log, buffer, size);
+    return size;
+}
+
+CompilerThread::CompilerThread(
+    ParserState state,
+    std::vector<bool> decisions,
+    uint16_t label
+) :
+    state(state),
+    decisions(decisions),
+    label(label) {}
+
+Checkpoint::Checkpoint(ParserState state, uint16_t label) :
+    state(state),
+    label(label) {}
+
+Compiler::Compiler(String inPath, bool precompiled) :
+    inPath_(inPath),
+    file_(),
+    address_(0),
+    failed_(false),
+    tooLarge_(false),
+    precompiled_(precompiled),
+    hasErrors_(false),
+    labels_(std::vector<uint32_t>()),
+    routines_(std::vector<Routine>()),
+    routineDoctypes_(std::vector<DoctypeDialect>()),
+    dependencies_(std::vector<Dependency>()),
+    copies_(std::vector<String>()),
+    gpios_(0),
+    decisionGpios_(0),
+    part_(std::vector<uint8_t>()),
+    staticLength_(SIZE_MAX),
+    logLength_(SIZE_MAX),
+    decisions_(std::vector<bool>()),
+    decision_(0),
+    undecided_(false),
+    undecidedExpression_(),
+    output_(*this),
+    log_(*this) {}
+
+bool Compiler::compile() {
+    String path = Program::pathFor(inPath_);
+
+    file_ = LittleFS.open(path, "w");
+    if (!file_) {
+        return false;
+    }
+
+    writeHeader(false);
+
+    // The source is the first routine, included pug files are added while compiling
+    depend(inPath_);
+    addRoutine(inPath_, DoctypeDialect::None);
+
+    for (uint16_t i = 0; i < routines_.size() && !failed_ && !tooLarge_; i++) {
+        compileRoutine(i);
+    }
+
+    if (tooLarge_ && !failed_) {
+        // Start over with a program that only tells to use the Parser
+        file_.close();
+        file_ = LittleFS.open(path, "w");
+        if (!file_) {
+            return false;
+        }
+
+        // The GPIOs of the parts that weren't compiled are unknown
+        routines_.clear();
+        labels_.clear();
+        gpios_ = UINT16_MAX;
+        decisionGpios_ = UINT16_MAX;
+        writeHeader(true);
+    }
+
+    writeTable();
+    file_.close();
+
+    // Don't leave a broken program behind
+    if (failed_) {
+        LittleFS.remove(path);
+        return false;
+    }
+
+    return true;
+}
+
+bool Compiler::hasErrors() {
+    return hasErrors_;
+}
+
+bool Compiler::isInterpreted() {
+    return tooLarge_ && !failed_;
+}
+
+Print &Compiler::output() {
+    return output_;
+}
+
+Print &Compiler::log() {
+    return log_;
+}
+
+bool Compiler::decide(const Expression &expression) {
+    gpios_ |= expression.gpios();
+    decisionGpios_ |= expression.gpios();
+
+    // Result for the path that is compiled
+    if (decision_ < decisions_.size()) {
+        return decisions_[decision_++];
+    }
+
+    // No result yet, the part is compiled again for both results
+    if (!undecided_) {
+        undecided_ = true;
+        undecidedExpression_ = expression;
+    }
+
+    return false;
+}
+
+void Compiler::value(GPIOId id) {
+    gpios_ |= gpioBit(id);
+
+    addOp(Op::Value);
+    addU8((uint8_t)id);
+}
+
+void Compiler::include(String path) {
+    addOp(Op::Include);
+    addString(path);
+
+    // The copy is part of the cached pages
+    depend(path);
+
+    for (const String &copy : copies_) {
+        if (copy == path) {
+            return;
+        }
+    }
+
+    copies_.push_back(path);
+}
+
+void Compiler::call(String path, DoctypeDialect doctype) {
+    uint16_t callee = addRoutine(path, doctype);
+
+    addOp(Op::Call);
+    addU16(callee);
+}
+
+void Compiler::depend(String path) {
+    for (const Dependency &dependency : dependencies_) {
+        if (dependency.path == path) {
+            return;
+        }
+    }
+
+    dependencies_.push_back(Dependency(path));
+}
+
+void Compiler::append(Op op, const uint8_t *buffer, size_t size) {
+    size_t &length = op == Op::Static ? staticLength_ : logLength_;
+    if (op == Op::Log) {
+        hasErrors_ = true;
+    }
+
+    while (size > 0) {
+        // Start a new instruction if the last one is another one or full
+        if (length == SIZE_MAX) {
+            addOp(op);
+            length = part_.size();
+            addU16(0);
+        }
+
+        uint16_t current = part_[length] | (part_[length + 1] << 8);
+        size_t amount = UINT16_MAX - current;
+        if (amount > size) {
+            amount = size;
+        }
+
+        part_.insert(part_.end(), buffer, buffer + amount);
+        current += amount;
+        part_[length] = current & 0xFF;
+        part_[length + 1] = current >> 8;
+
+        buffer += amount;
+        size -= amount;
+
+        if (current == UINT16_MAX) {
+            length = SIZE_MAX;
+        }
+    }
+}
+
+uint16_t Compiler::addRoutine(String path, DoctypeDialect doctype) {
+    // Reuse the routine if the file was already included with the same dialect
+    uint16_t routine = 0;
+    while (routine < routines_.size()
+           && (routines_[routine].path != path
+               || routineDoctypes_[routine] != doctype)) {
+        routine++;
+    }
+
+    if (routine == routines_.size()) {
+        if (routines_.size() == UINT16_MAX) {
+            tooLarge_ = true;
+            return 0;
+        }
+
+        routines_.push_back(Routine(path, newLabel()));
+        routineDoctypes_.push_back(doctype);
+    }
+
+    return routine;
+}
+
+/**
+ * @brief Order of the paths that still have to be compiled, as a heap
+ *
+ * @param thread A path
+ * @param other Another path
+ * @return bool Wether the path is further in the source than the other one
+ */
+static bool isFurther(
+    const CompilerThread &thread,
+    const CompilerThread &other
+) {
+    return thread.state.scanner.position > other.state.scanner.position;
+}
+
+void Compiler::compileRoutine(uint16_t routine) {
+    Parser parser = Parser(
+        routines_[routine].path,
+        *this,
+        routineDoctypes_[routine]
+    );
+
+    // Paths that still have to be compiled, starting with the whole source.
+    // The path that is furthest behind in the source is compiled first
+    std::vector<CompilerThread> threads = std::vector<CompilerThread>();
+    threads.push_back(CompilerThread(
+        parser.state(),
+        std::vector<bool>(),
+        routines_[routine].label
+    ));
+
+    // Already compiled states that paths behind might reach
+    std::vector<Checkpoint> checkpoints = std::vector<Checkpoint>();
+
+    while (!threads.empty() && !failed_ && !tooLarge_) {
+        std::pop_heap(threads.begin(), threads.end(), isFurther);
+        CompilerThread thread = threads.back();
+        threads.pop_back();
+        placeLabel(thread.label);
+
+        ParserState state = thread.state;
+        std::vector<bool> decisions = thread.decisions;
+
+        // Paths only move forward, no path reaches the states before this one
+        size_t kept = 0;
+        for (size_t i = 0; i < checkpoints.size(); i++) {
+            if (checkpoints[i].state.scanner.position
+                >= state.scanner.position) {
+                checkpoints[kept++] = checkpoints[i];
+            }
+        }
+        checkpoints.erase(checkpoints.begin() + kept, checkpoints.end());
+
+        while (!failed_ && !tooLarge_) {
+            // Give up on sources with too many paths
+            size_t memory = compileArena.used()
+                + threads.capacity() * sizeof(CompilerThread)
+                + checkpoints.capacity() * sizeof(Checkpoint);
+            if (address_ > AALEC_PUG_PROGRAM_MAX_SIZE
+                || memory > AALEC_PUG_COMPILE_MAX_MEMORY) {
+                tooLarge_ = true;
+                break;
+            }
+
+            // At the start of a part, continue with an already compiled path
+            // if it has the same state
+            if (decisions.empty()) {
+                const Checkpoint *same = nullptr;
+                for (const Checkpoint &checkpoint : checkpoints) {
+                    if (checkpoint.state.equals(state)) {
+                        same = &checkpoint;
+                        break;
+                    }
+                }
+
+                // Except for a path that waited at its own checkpoint
+                if (same != nullptr && same->label != thread.label) {
+                    startPart(decisions);
+                    addOp(Op::Jump);
+                    addU16(same->label);
+                    writePart();
+                    break;
+                }
+
+                // Only paths behind this one can reach the state later
+                if (same == nullptr && !threads.empty()
+                    && threads.front().state.scanner.position
+                           <= state.scanner.position) {
+                    uint16_t label = newLabel();
+                    checkpoints.push_back(Checkpoint(state, label));
+
+                    // Let the paths behind catch up before keeping more
+                    if (checkpoints.size()
+                        > AALEC_PUG_COMPILE_MAX_CHECKPOINTS) {
+                        startPart(decisions);
+                        addOp(Op::Jump);
+                        addU16(label);
+                        writePart();
+
+                        threads.push_back(
+                            CompilerThread(state, std::vector<bool>(), label)
+                        );
+                        std::push_heap(
+                            threads.begin(),
+                            threads.end(),
+                            isFurther
+                        );
+                        break;
+                    }
+
+                    placeLabel(label);
+                }
+            }
+
+            // Parse the part for the path
+            parser.restore(state);
+            startPart(decisions);
+            bool done = false;
+            bool success = parser.parsePart(done);
+
+            // An expression without a result splits the path, the part is
+            // parsed again for both results
+            if (undecided_) {
+                Expression expression = undecidedExpression_;
+                uint16_t label = newLabel();
+
+                startPart(decisions);
+                addOp(Op::Branch);
+                addU8((uint8_t)expression.type);
+                addU8((uint8_t)expression.left.type);
+                addU32(expression.left.value);
+                addU8((uint8_t)expression.right.type);
+                addU32(expression.right.value);
+                addU16(label);
+                writePart();
+
+                std::vector<bool> falseDecisions = decisions;
+                falseDecisions.push_back(false);
+                threads.push_back(CompilerThread(state, falseDecisions, label));
+                std::push_heap(threads.begin(), threads.end(), isFurther);
+
+                decisions.push_back(true);
+                continue;
+            }
+
+            if (!success || done) {
+                addOp(Op::End);
+                addU8(success ? 1 : 0);
+                writePart();
+                break;
+            }
+
+            writePart();
+            state = parser.state();
+            decisions.clear();
+        }
+    }
+}
+
+void Compiler::startPart(const std::vector<bool> &decisions) {
+    part_.clear();
+    staticLength_ = SIZE_MAX;
+    logLength_ = SIZE_MAX;
+    decisions_ = decisions;
+    decision_ = 0;
+    undecided_ = false;
+}
+
+void Compiler::writePart() {
+    if (!part_.empty()
+        && file_.write(part_.data(), part_.size()) != part_.size()) {
+        failed_ = true;
+    }
+
+    address_ += part_.size();
+
+    part_.clear();
+    staticLength_ = SIZE_MAX;
+    logLength_ = SIZE_MAX;
+}
+
+uint16_t Compiler::newLabel() {
+    if (labels_.size() == UINT16_MAX) {
+        tooLarge_ = true;
+        return 0;
+    }
+
+    labels_.push_back(UINT32_MAX);
+    return labels_.size() - 1;
+}
+
+void Compiler::placeLabel(uint16_t label) {
+    labels_[label] = address_;
+}
+
+void Compiler::addOp(Op op) {
+    part_.push_back((uint8_t)op);
+    staticLength_ = SIZE_MAX;
+    logLength_ = SIZE_MAX;
+}
+
+void Compiler::addU8(uint8_t value) {
+    part_.push_back(value);
+}
+
+void Compiler::addU16(uint16_t value) {
+    part_.push_back(value & 0xFF);
+    part_.push_back(value >> 8);
+}
+
+void Compiler::addU32(uint32_t value) {
+    addU16(value & 0xFFFF);
+    addU16(value >> 16);
+}
+
+void Compiler::addString(const String &value) {
+    addU16(value.length());
+    part_.insert(part_.end(), value.c_str(), value.c_str() + value.length());
+}
+
+void Compiler::writeHeader(bool interpreted) {
+    address_ = 0;
+    part_.clear();
+
+    for (char magic : {'A', 'P', 'U', 'G'}) {
+        addU8(magic);
+    }
+    addU8(AALEC_PUG_PROGRAM_VERSION);
+    addU8(
+        (interpreted ? 1 : 0) | (Parser::tagValues() ? 2 : 0)
+        | (precompiled_ ? 4 : 0)
+    );
+    writePart();
+}
+
+void Compiler::writeTable() {
+    uint32_t tableStart = address_;
+
+    addU16(gpios_);
+    addU16(decisionGpios_);
+
+    addU16(dependencies_.size());
+    for (const Dependency &dependency : dependencies_) {
+        addString(dependency.path);
+        addU32(dependency.size);
+        addU32(precompiled_ ? dependency.checksum() : dependency.lastWrite);
+    }
+
+    addU16(copies_.size());
+    for (const String &copy : copies_) {
+        addString(copy);
+    }
+
+    addU16(routines_.size());
+    for (const Routine &routine : routines_) {
+        addU16(routine.label);
+        addString(routine.path);
+    }
+
+    addU16(labels_.size());
+    for (uint32_t label : labels_) {
+        addU32(label);
+    }
+
+    addU32(tableStart);
+
+    writePart();
+}
@@ -0,0 +1,456 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <parser/parser.h>
+#include <program/program.h>
+
+/**
+ * @brief Maximum size of the instructions of a program in bytes.
+ *        Sources that would need more are rendered by the Parser instead.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_PROGRAM_MAX_SIZE
+    #define AALEC_PUG_PROGRAM_MAX_SIZE 32768
+#endif
+
+/**
+ * @brief Maximum memory of a compile in bytes, the chunks of `compileArena`
+ *        and the parser states that are kept for the paths. Sources that
+ *        would need more are rendered by the Parser instead.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_COMPILE_MAX_MEMORY
+    #define AALEC_PUG_COMPILE_MAX_MEMORY 16384
+#endif
+
+/**
+ * @brief Maximum amount of parser states a compile keeps for joining paths.
+ *        A path that gets further ahead waits for the others to catch up.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_COMPILE_MAX_CHECKPOINTS
+    #define AALEC_PUG_COMPILE_MAX_CHECKPOINTS 16
+#endif
+
+/**
+ * @brief Receives the HTML from the Parser while compiling
+ */
+class CompilerOutput : public Print {
+   private:
+    /**
+     * @brief The compiler
+     */
+    Compiler &compiler_;
+
+   public:
+    /**
+     * @brief Construct a new Compiler Output object
+     *
+     * @param compiler The compiler
+     */
+    CompilerOutput(Compiler &compiler);
+
+    size_t write(uint8_t value) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+/**
+ * @brief Receives the errors from the Scanner and Parser while compiling
+ */
+class CompilerLog : public Print {
+   private:
+    /**
+     * @brief The compiler
+     */
+    Compiler &compiler_;
+
+   public:
+    /**
+     * @brief Construct a new Compiler Log object
+     *
+     * @param compiler The compiler
+     */
+    CompilerLog(Compiler &compiler);
+
+    size_t write(uint8_t value) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+/**
+ * @brief A path through a source that still has to be compiled
+ */
+class CompilerThread {
+   public:
+    /**
+     * @brief State of the parser at the start of the next part
+     */
+    ParserState state;
+
+    /**
+     * @brief Results of the GPIO dependent expressions in the next part
+     */
+    std::vector<bool> decisions;
+
+    /**
+     * @brief Label of the first instruction of the path
+     */
+    uint16_t label;
+
+    /**
+     * @brief Construct a new Compiler Thread object
+     *
+     * @param state State of the parser at the start of the next part
+     * @param decisions Results of the GPIO dependent expressions in the next part
+     * @param label Label of the first instruction of the path
+     */
+    CompilerThread(
+        ParserState state,
+        std::vector<bool> decisions,
+        uint16_t label
+    );
+};
+
+/**
+ * @brief An already compiled state of the parser, other paths that reach
+ *        the same state jump to its label instead of being compiled again
+ */
+class Checkpoint {
+   public:
+    /**
+     * @brief State of the parser at the start of a part
+     */
+    ParserState state;
+
+    /**
+     * @brief Label of the instructions that continue from the state
+     */
+    uint16_t label;
+
+    /**
+     * @brief Construct a new Checkpoint object
+     *
+     * @param state State of the parser at the start of a part
+     * @param label Label of the instructions that continue from the state
+     */
+    Checkpoint(ParserState state, uint16_t label);
+};
+
+/**
+ * @brief Compiles a pug file and its included pug files into a Program.
+ *
+ *        The Parser runs part by part over the source. GPIO values in texts are
+ *        left to the program. When a part depends on a GPIO expression it is
+ *        parsed once for each result, behind a Branch instruction. Paths that
+ *        reach the same parser state continue with the same instructions
+ */
+class Compiler {
+   private:
+    /**
+     * @brief The path to the pug file that is compiled
+     */
+    String inPath_;
+
+    /**
+     * @brief The program file that is written
+     */
+    File file_;
+
+    /**
+     * @brief Position of the next instruction in the program file
+     */
+    uint32_t address_;
+
+    /**
+     * @brief Wether writing the program file failed
+     */
+    bool failed_;
+
+    /**
+     * @brief Wether the program exceeds `AALEC_PUG_PROGRAM_MAX_SIZE`
+     */
+    bool tooLarge_;
+
+    /**
+     * @brief Wether the program is compiled on a host and uploaded later,
+     *        checksums of the dependencies are stored instead of their times
+     */
+    bool precompiled_;
+
+    /**
+     * @brief Wether errors were added to the program
+     */
+    bool hasErrors_;
+
+    /**
+     * @brief Positions of the labels in the program file, UINT32_MAX if not placed yet
+     */
+    std::vector<uint32_t> labels_;
+
+    /**
+     * @brief The compiled pug files
+     */
+    std::vector<Routine> routines_;
+
+    /**
+     * @brief The HTML dialect each routine is compiled with
+     */
+    std::vector<DoctypeDialect> routineDoctypes_;
+
+    /**
+     * @brief The files the program is compiled from
+     */
+    std::vector<Dependency> dependencies_;
+
+    /**
+     * @brief The plain files that are copied into the output
+     */
+    std::vector<String> copies_;
+
+    /**
+     * @brief Bit mask of the GPIOs the program reads, see `gpioBit()`
+     */
+    u16 gpios_;
+
+    /**
+     * @brief Bit mask of the GPIOs expressions read, see `gpioBit()`
+     */
+    u16 decisionGpios_;
+
+    /**
+     * @brief Instructions of the current part, written once the part is complete
+     */
+    std::vector<uint8_t> part_;
+
+    /**
+     * @brief Index of the length of the last Static instruction in the part,
+     *        SIZE_MAX if the last instruction isn't one
+     */
+    size_t staticLength_;
+
+    /**
+     * @brief Index of the length of the last Log instruction in the part,
+     *        SIZE_MAX if the last instruction isn't one
+     */
+    size_t logLength_;
+
+    /**
+     * @brief Results of the GPIO dependent expressions in the current part
+     */
+    std::vector<bool> decisions_;
+
+    /**
+     * @brief Index of the next result in `decisions_`
+     */
+    size_t decision_;
+
+    /**
+     * @brief Wether the part reached an expression without a result
+     */
+    bool undecided_;
+
+    /**
+     * @brief The first expression without a result
+     */
+    Expression undecidedExpression_;
+
+    /**
+     * @brief Receives the HTML
+     */
+    CompilerOutput output_;
+
+    /**
+     * @brief Receives the errors
+     */
+    CompilerLog log_;
+
+   public:
+    /**
+     * @brief Construct a new Compiler object
+     *
+     * @param inPath Path to the pug file
+     * @param precompiled Wether the program is compiled on a host and uploaded
+     *                    to the device later, defaults to false
+     */
+    Compiler(String inPath, bool precompiled = false);
+
+    /**
+     * @brief Compile the source and write the program file next to it.
+     *        If the program would get too large, the program file only tells
+     *        that the source must be rendered by the Parser
+     *
+     * @return bool Wether the program file could be written
+     */
+    bool compile();
+
+    /**
+     * @brief Checks if the source has errors, they are printed when the
+     *        program is rendered
+     *
+     * @return bool Wether errors were added to the program
+     */
+    bool hasErrors();
+
+    /**
+     * @brief Checks if the source was too large to compile, the program only
+     *        tells that the source must be rendered by the Parser
+     *
+     * @return bool Wether the program is interpreted
+     */
+    bool isInterpreted();
+
+    // Called by the Scanner and Parser while compiling
+
+    /**
+     * @brief Where the HTML is written to
+     *
+     * @return Print& The output for the HTML
+     */
+    Print &output();
+
+    /**
+     * @brief Where errors are written to, they are printed when the program is rendered
+     *
+     * @return Print& The output for errors
+     */
+    Print &log();
+
+    /**
+     * @brief Result of a GPIO dependent expression for the path that is compiled
+     *
+     * @param expression The expression
+     * @return bool The result
+     */
+    bool decide(const Expression &expression);
+
+    /**
+     * @brief Add the value of a GPIO to the output
+     *
+     * @param id The GPIO
+     */
+    void value(GPIOId id);
+
+    /**
+     * @brief Add a plain file to the output, it is copied when rendering
+     *
+     * @param path Path to the file
+     */
+    void include(String path);
+
+    /**
+     * @brief Add an included pug file to the output, it is compiled into its own routine
+     *
+     * @param path Path to the pug file
+     * @param doctype The HTML dialect
+     */
+    void call(String path, DoctypeDialect doctype);
+
+    /**
+     * @brief Recompile the program when the file changes
+     *
+     * @param path Path to the file
+     */
+    void depend(String path);
+
+    /**
+     * @brief Add bytes to the current Static or Log instruction, or start a new one
+     *
+     * @param op Op::Static or Op::Log
+     * @param buffer The bytes
+     * @param size Amount of bytes
+     */
+    void append(Op op, const uint8_t *buffer, size_t size);
+
+   private:
+    /**
+     * @brief Get the routine of a pug file, adds it if it doesn't exist yet
+     *
+     * @param path Path to the pug file
+     * @param doctype The HTML dialect
+     * @return uint16_t Index of the routine
+     */
+    uint16_t addRoutine(String path, DoctypeDialect doctype);
+
+    /**
+     * @brief Compile a routine
+     *
+     * @param routine Index of the routine
+     */
+    void compileRoutine(uint16_t routine);
+
+    /**
+     * @brief Start a part, discards the instructions of the previous one
+     *
+     * @param decisions Results of the GPIO dependent expressions in the part
+     */
+    void startPart(const std::vector<bool> &decisions);
+
+    /**
+     * @brief Write the instructions of the part to the program file
+     */
+    void writePart();
+
+    /**
+     * @brief Create a new label
+     *
+     * @return uint16_t The label
+     */
+    uint16_t newLabel();
+
+    /**
+     * @brief Place a label at the next instruction
+     *
+     * @param label The label
+     */
+    void placeLabel(uint16_t label);
+
+    /**
+     * @brief Add an instruction to the part
+     *
+     * @param op The instruction
+     */
+    void addOp(Op op);
+
+    /**
+     * @brief Add an u8 to the part
+     *
+     * @param value The number
+     */
+    void addU8(uint8_t value);
+
+    /**
+     * @brief Add an u16 to the part
+     *
+     * @param value The number
+     */
+    void addU16(uint16_t value);
+
+    /**
+     * @brief Add an u32 to the part
+     *
+     * @param value The number
+     */
+    void addU32(uint32_t value);
+
+    /**
+     * @brief Add a string with a leading u16 length to the part
+     *
+     * @param value The string
+     */
+    void addString(const String &value);
+
+    /**
+     * @brief Write the header of the program file
+     *
+     * @param interpreted Wether the source must be rendered by the Parser
+     */
+    void writeHeader(bool interpreted);
+
+    /**
+     * @brief Write the table of the program file
+     */
+    void writeTable();
+};
+
+#endif  // COMPILER_H
@@ -0,0 +1,83 @@
+#include "emitter.h"
+
+#include <algorithm>
+
+uint32_t Emitter::writes_ = 0;
+
+uint32_t Emitter::bytes_ = 0;
+
+Emitter::Emitter(Print &out, size_t chunkSize) :
+    out_(out),
+    chunkSize_(
+        chunkSize > 0 && chunkSize <= AALEC_PUG_EMITTER_BUFFER_SIZE
+            ? chunkSize
+            : AALEC_PUG_EMITTER_BUFFER_SIZE
+    ),
+    flushSize_(
+        AALEC_PUG_EMITTER_BUFFER_SIZE
+        - AALEC_PUG_EMITTER_BUFFER_SIZE % chunkSize_
+    ),
+    length_(0) {}
+
+Emitter::~Emitter() {
+    flush();
+}
+
+size_t Emitter::write(uint8_t value) {
+    buffer_[length_++] = value;
+    if (length_ == flushSize_) {
+        emit(buffer_, length_);
+        length_ = 0;
+    }
+
+    return 1;
+}
+
+size_t Emitter::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        // Large writes skip the buffer, in whole chunks so writes stay aligned
+        if (length_ == 0 && size - written >= flushSize_) {
+            size_t amount = size - written;
+            amount -= amount % chunkSize_;
+            emit(buffer + written, amount);
+            written += amount;
+            continue;
+        }
+
+        // Fill the buffer
+        size_t amount = std::min(size - written, flushSize_ - length_);
+        memcpy(buffer_ + length_, buffer + written, amount);
+        length_ += amount;
+        written += amount;
+
+        // Write the buffer if it is full
+        if (length_ == flushSize_) {
+            emit(buffer_, length_);
+            length_ = 0;
+        }
+    }
+
+    return written;
+}
+
+void Emitter::flush() {
+    if (length_ > 0) {
+        emit(buffer_, length_);
+        length_ = 0;
+    }
+}
+
+uint32_t Emitter::writes() {
+    return writes_;
+}
+
+uint32_t Emitter::bytes() {
+    return bytes_;
+}
+
+void Emitter::emit(const uint8_t *buffer, size_t size) {
+    out_.write(buffer, size);
+    writes_++;
+    bytes_ += size;
+}
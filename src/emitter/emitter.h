@@ -0,0 +1,126 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Size of the buffer of the Emitter in bytes.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_EMITTER_BUFFER_SIZE
+    #define AALEC_PUG_EMITTER_BUFFER_SIZE 536
+#endif
+
+/**
+ * @brief Size of the chunks written to a `Print` in bytes,
+ *        default is the TCP segment size of the ESP8266 core.
+ *        Can be overwritten with a build flag (eg: 1460 for larger segments)
+ */
+#ifndef AALEC_PUG_OUTPUT_CHUNK_SIZE
+    #define AALEC_PUG_OUTPUT_CHUNK_SIZE 536
+#endif
+
+/**
+ * @brief Size of the chunks written to a file in bytes,
+ *        default is the page size of LittleFS.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_FILE_CHUNK_SIZE
+    #define AALEC_PUG_FILE_CHUNK_SIZE 256
+#endif
+
+/**
+ * @brief Collects the HTML in a fixed buffer and writes it to the output
+ *        in multiples of a chunk size, so small writes don't each reach the
+ *        file system or the network
+ */
+class Emitter : public Print {
+   private:
+    /**
+     * @brief The output
+     */
+    Print &out_;
+
+    /**
+     * @brief Size of the chunks in bytes
+     */
+    size_t chunkSize_;
+
+    /**
+     * @brief Amount of bytes after which the buffer is written,
+     *        the largest multiple of the chunk size that fits into the buffer
+     */
+    size_t flushSize_;
+
+    /**
+     * @brief The buffer
+     */
+    uint8_t buffer_[AALEC_PUG_EMITTER_BUFFER_SIZE];
+
+    /**
+     * @brief Amount of bytes in the buffer
+     */
+    size_t length_;
+
+    /**
+     * @brief Amount of writes to the outputs of all emitters
+     */
+    static uint32_t writes_;
+
+    /**
+     * @brief Amount of bytes written to the outputs of all emitters
+     */
+    static uint32_t bytes_;
+
+   public:
+    /**
+     * @brief Construct a new Emitter object
+     *
+     * @param out The output
+     * @param chunkSize Size of the chunks in bytes, at most the buffer size
+     */
+    Emitter(Print &out, size_t chunkSize);
+
+    /**
+     * @brief Destroy the Emitter object, writes the rest of the buffer
+     */
+    ~Emitter();
+
+    Emitter(const Emitter &emitter) = delete;
+
+    Emitter &operator=(const Emitter &emitter) = delete;
+
+    size_t write(uint8_t value) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    /**
+     * @brief Write the rest of the buffer to the output
+     */
+    void flush() override;
+
+    /**
+     * @brief Amount of writes to the outputs of all emitters
+     *
+     * @return uint32_t The amount
+     */
+    static uint32_t writes();
+
+    /**
+     * @brief Amount of bytes written to the outputs of all emitters
+     *
+     * @return uint32_t The amount
+     */
+    static uint32_t bytes();
+
+   private:
+    /**
+     * @brief Write bytes to the output and count the write
+     *
+     * @param buffer The bytes
+     * @param size Amount of bytes
+     */
+    void emit(const uint8_t *buffer, size_t size);
+};
+
+#endif  // EMITTER_H
@@ -0,0 +1,46 @@
+#include "etag.h"
+
+ETag::ETag() : hash_(2166136261u), weak_(false) {}
+
+void ETag::add(const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash_ ^= data[i];
+        hash_ *= 16777619u;
+    }
+}
+
+void ETag::add(u32 value) {
+    // Little endian, so the tag is the same on every platform
+    uint8_t bytes[4] = {
+        (uint8_t)value,
+        (uint8_t)(value >> 8),
+        (uint8_t)(value >> 16),
+        (uint8_t)(value >> 24),
+    };
+    add(bytes, sizeof(bytes));
+}
+
+void ETag::add(const String &value) {
+    add((u32)value.length());
+    add((const uint8_t *)value.c_str(), value.length());
+}
+
+void ETag::setWeak() {
+    weak_ = true;
+}
+
+u32 ETag::hash() const {
+    return hash_;
+}
+
+String ETag::toString() const {
+    char tag[16];
+    snprintf_P(
+        tag,
+        sizeof(tag),
+        PSTR("%s\"%08x\""),
+        weak_ ? "W/" : "",
+        (unsigned int)hash_
+    );
+    return String(tag);
+}
@@ -0,0 +1,70 @@
+#ifndef ETAG_H
+#define ETAG_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Builds an HTTP entity tag from everything the content depends on,
+ *        using the 32 bit FNV-1a hash
+ */
+class ETag {
+   private:
+    /**
+     * @brief The hash of everything added so far
+     */
+    u32 hash_;
+
+    /**
+     * @brief Wether equal tags don't guarantee byte for byte equal content
+     */
+    bool weak_;
+
+   public:
+    /**
+     * @brief Construct a new strong ETag object without any content
+     */
+    ETag();
+
+    /**
+     * @brief Add bytes to the hash
+     *
+     * @param data The bytes
+     * @param size Amount of bytes
+     */
+    void add(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Add a number to the hash
+     *
+     * @param value The number
+     */
+    void add(u32 value);
+
+    /**
+     * @brief Add a string and its length to the hash
+     *
+     * @param value The string
+     */
+    void add(const String &value);
+
+    /**
+     * @brief Mark the tag as weak, equal tags only mean equivalent content
+     */
+    void setWeak();
+
+    /**
+     * @brief The hash of everything added so far, eg: as checksum of a file
+     *
+     * @return u32 The hash
+     */
+    u32 hash() const;
+
+    /**
+     * @brief The tag as it is used in the `ETag` header, eg: "1a2b3c4d" or W/"1a2b3c4d"
+     *
+     * @return String The tag
+     */
+    String toString() const;
+};
+
+#endif  // ETAG_H
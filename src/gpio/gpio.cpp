@@ -0,0 +1,231 @@
+#include "gpio.h"
+
+#include <AALeC-V2.h>
+
+u16 gpioBit(GPIOId id) {
+    return 1 << (uint8_t)id;
+}
+
+const char *gpioKey(GPIOId id) {
+    switch (id) {
+        case GPIOId::LED:
+            return "IO_LED";
+        case GPIOId::Button:
+            return "IO_BUTTON";
+        case GPIOId::Rotate:
+            return "IO_ROTATE";
+        case GPIOId::Temp:
+            return "IO_TEMP";
+        case GPIOId::Humidity:
+            return "IO_HUMIDITY";
+        case GPIOId::Analog:
+            return "IO_ANALOG";
+        case GPIOId::TempAge:
+            return "IO_TEMP_AGE";
+        case GPIOId::HumidityAge:
+            return "IO_HUMIDITY_AGE";
+        default:
+            return "";
+    }
+}
+
+u32 readGPIO(GPIOId id) {
+    switch (id) {
+        case GPIOId::LED:
+            return aalec.get_led();
+        case GPIOId::Button:
+            return aalec.get_button();
+        case GPIOId::Rotate:
+            return aalec.get_rotate();
+        case GPIOId::Temp:
+            return aalec.get_temp();
+        case GPIOId::Humidity:
+            return aalec.get_humidity();
+        case GPIOId::Analog:
+            return aalec.get_analog();
+        default:
+            return 0;
+    }
+}
+
+GPIOSampler gpioSampler = GPIOSampler();
+
+GPIOSampler::GPIOSampler() :
+    intervals_(),
+    values_(),
+    sampledAt_(),
+    sampled_(0) {}
+
+void GPIOSampler::setInterval(GPIOId id, unsigned long interval) {
+    if (id == GPIOId::None || (size_t)id >= AALEC_PUG_GPIO_COUNT) {
+        return;
+    }
+
+    intervals_[(size_t)id] = interval;
+
+    // Stopped GPIOs are read by the renders again
+    if (interval == 0) {
+        sampled_ &= ~(1 << (uint8_t)id);
+    }
+}
+
+void GPIOSampler::update() {
+    unsigned long now = millis();
+
+    // Find the GPIO that is overdue the longest, never read ones first
+    size_t due = 0;
+    unsigned long dueFor = 0;
+    for (size_t i = 1; i < AALEC_PUG_GPIO_COUNT; i++) {
+        if (intervals_[i] == 0) {
+            continue;
+        }
+
+        if (!(sampled_ & (1 << i))) {
+            due = i;
+            break;
+        }
+
+        unsigned long age = now - sampledAt_[i];
+        if (age < intervals_[i]) {
+            continue;
+        }
+
+        if (due == 0 || age - intervals_[i] > dueFor) {
+            due = i;
+            dueFor = age - intervals_[i];
+        }
+    }
+
+    if (due == 0) {
+        return;
+    }
+
+    values_[due] = readGPIO((GPIOId)due);
+    sampledAt_[due] = millis();
+    sampled_ |= 1 << due;
+}
+
+bool GPIOSampler::has(GPIOId id) const {
+    return id != GPIOId::None && (size_t)id < AALEC_PUG_GPIO_COUNT
+        && (sampled_ & (1 << (uint8_t)id));
+}
+
+u32 GPIOSampler::value(GPIOId id) const {
+    return has(id) ? values_[(size_t)id] : 0;
+}
+
+unsigned long GPIOSampler::age(GPIOId id) const {
+    return has(id) ? millis() - sampledAt_[(size_t)id] : 0;
+}
+
+uint32_t GPIOSnapshot::reads_ = 0;
+
+uint32_t GPIOSnapshot::avoidedReads_ = 0;
+
+GPIOSnapshot::GPIOSnapshot() : values_(), ages_(), read_(0) {}
+
+GPIOSnapshot::GPIOSnapshot(const GPIOSampler &sampler) :
+    values_(),
+    ages_(),
+    read_(0) {
+    // Take all sampled values at once, so they don't change during the render
+    for (size_t i = 1; i < AALEC_PUG_GPIO_COUNT; i++) {
+        if (sampler.has((GPIOId)i)) {
+            values_[i] = sampler.value((GPIOId)i);
+            ages_[i] = sampler.age((GPIOId)i);
+            read_ |= 1 << i;
+        }
+    }
+}
+
+u32 GPIOSnapshot::read(GPIOId id) {
+    // The ages belong to the value of another GPIO
+    if (id == GPIOId::TempAge) {
+        return ages_[(size_t)GPIOId::Temp];
+    } else if (id == GPIOId::HumidityAge) {
+        return ages_[(size_t)GPIOId::Humidity];
+    } else if (id == GPIOId::None || (size_t)id >= AALEC_PUG_GPIO_COUNT) {
+        return 0;
+    }
+
+    // Answer from the snapshot if the GPIO was already read
+    uint8_t bit = 1 << (uint8_t)id;
+    if (read_ & bit) {
+        avoidedReads_++;
+        return values_[(size_t)id];
+    }
+
+    values_[(size_t)id] = readGPIO(id);
+    read_ |= bit;
+    reads_++;
+
+    return values_[(size_t)id];
+}
+
+uint32_t GPIOSnapshot::reads() {
+    return reads_;
+}
+
+uint32_t GPIOSnapshot::avoidedReads() {
+    return avoidedReads_;
+}
+
+Operand::Operand() : type(OperandType::False), value(0) {}
+
+Operand::Operand(OperandType type, u32 value) : type(type), value(value) {}
+
+u32 Operand::evaluate(GPIOSnapshot &gpios) const {
+    switch (type) {
+        case OperandType::True:
+            return 1;
+        case OperandType::Number:
+            return value;
+        case OperandType::GPIO:
+            return gpios.read((GPIOId)value);
+        default:
+            return 0;
+    }
+}
+
+Expression::Expression() : type(ExpressionType::Value), left(), right() {}
+
+bool Expression::evaluate(GPIOSnapshot &gpios) const {
+    // Read the keys in the order they appear in the source
+    u32 leftResult = left.evaluate(gpios);
+    bool leftIsTrue = left.type == OperandType::True;
+
+    if (type == ExpressionType::Value) {
+        return leftIsTrue || leftResult != 0;
+    }
+
+    u32 rightResult = right.evaluate(gpios);
+    bool rightIsTrue = right.type == OperandType::True;
+
+    if (leftIsTrue && rightIsTrue) {
+        return true;
+    } else if (leftIsTrue) {
+        return rightResult != 0;
+    } else if (rightIsTrue) {
+        return leftResult != 0;
+    } else {
+        return leftResult == rightResult;
+    }
+}
+
+bool Expression::isConstant() const {
+    return left.type != OperandType::GPIO
+        && (type == ExpressionType::Value || right.type != OperandType::GPIO);
+}
+
+u16 Expression::gpios() const {
+    u16 gpios = 0;
+
+    if (left.type == OperandType::GPIO) {
+        gpios |= gpioBit((GPIOId)left.value);
+    }
+    if (type == ExpressionType::Equals && right.type == OperandType::GPIO) {
+        gpios |= gpioBit((GPIOId)right.value);
+    }
+
+    return gpios;
+}
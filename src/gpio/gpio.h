@@ -0,0 +1,304 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <Arduino.h>
+
+/**
+ * @brief The GPIO IDs that can be used in the source
+ */
+enum class GPIOId : uint8_t {
+    None,
+    LED,
+    Button,
+    Rotate,
+    Temp,
+    Humidity,
+    Analog,
+    TempAge,
+    HumidityAge,
+};
+
+/**
+ * @brief Amount of GPIOIds up to the last one that is read from the hardware.
+ *        The GPIOIds after it are the ages of sampled values
+ */
+#define AALEC_PUG_GPIO_COUNT ((size_t)GPIOId::Analog + 1)
+
+/**
+ * @brief The bit of a GPIO in a bit mask of GPIOIds
+ *
+ * @param id The GPIO ID
+ * @return u16 The bit, `1 << id`
+ */
+u16 gpioBit(GPIOId id);
+
+/**
+ * @brief The key of a GPIO in the source
+ *
+ * @param id The GPIO ID
+ * @return const char* The key, eg: "IO_TEMP", empty for GPIOId::None
+ */
+const char *gpioKey(GPIOId id);
+
+/**
+ * @brief Reads the current value of a GPIO from the hardware
+ *
+ * @param id The GPIO ID
+ * @return u32 The value, 0 for GPIOId::None and the ages
+ */
+u32 readGPIO(GPIOId id);
+
+/**
+ * @brief Reads GPIOs in the background, each on its own interval.
+ *        Renders use the sampled values instead of reading the hardware,
+ *        so slow sensors don't block them
+ */
+class GPIOSampler {
+   private:
+    /**
+     * @brief Milliseconds between two reads of each GPIO, 0 if it isn't sampled
+     */
+    unsigned long intervals_[AALEC_PUG_GPIO_COUNT];
+
+    /**
+     * @brief The last sampled value of each GPIO
+     */
+    u32 values_[AALEC_PUG_GPIO_COUNT];
+
+    /**
+     * @brief Time in milliseconds of the last read of each GPIO
+     */
+    unsigned long sampledAt_[AALEC_PUG_GPIO_COUNT];
+
+    /**
+     * @brief Bit mask of the GPIOIds that have a sampled value
+     */
+    uint8_t sampled_;
+
+   public:
+    /**
+     * @brief Construct a new GPIOSampler object that doesn't sample any GPIO
+     */
+    GPIOSampler();
+
+    /**
+     * @brief Set how often a GPIO is read
+     *
+     * @param id The GPIO ID, GPIOId::LED to GPIOId::Analog
+     * @param interval Milliseconds between two reads, 0 stops sampling the GPIO
+     */
+    void setInterval(GPIOId id, unsigned long interval);
+
+    /**
+     * @brief Read the GPIO that is overdue the longest, if any.
+     *        At most one GPIO is read per call, call it from `loop()`
+     */
+    void update();
+
+    /**
+     * @brief Checks if there is a sampled value of a GPIO
+     *
+     * @param id The GPIO ID
+     * @return bool Wether the GPIO is sampled and was read at least once
+     */
+    bool has(GPIOId id) const;
+
+    /**
+     * @brief The last sampled value of a GPIO
+     *
+     * @param id The GPIO ID
+     * @return u32 The value, 0 if there is none
+     */
+    u32 value(GPIOId id) const;
+
+    /**
+     * @brief Milliseconds since the last sampled value of a GPIO was read
+     *
+     * @param id The GPIO ID
+     * @return unsigned long The age, 0 if there is no sampled value
+     */
+    unsigned long age(GPIOId id) const;
+};
+
+/**
+ * @brief The sampler that is used by all renders.
+ *        Doesn't sample anything until an interval is set
+ */
+extern GPIOSampler gpioSampler;
+
+/**
+ * @brief The GPIO values of one render.
+ *        Each GPIO is read on its first use, later uses get the same value,
+ *        so slow sensors are read once and the values agree within a page
+ */
+class GPIOSnapshot {
+   private:
+    /**
+     * @brief The values that were read, indexed by the GPIOId
+     */
+    u32 values_[AALEC_PUG_GPIO_COUNT];
+
+    /**
+     * @brief Age in milliseconds of each value, 0 if it was read by the snapshot
+     */
+    unsigned long ages_[AALEC_PUG_GPIO_COUNT];
+
+    /**
+     * @brief Bit mask of the GPIOIds that were read
+     */
+    uint8_t read_;
+
+    /**
+     * @brief Amount of GPIO reads of all snapshots
+     */
+    static uint32_t reads_;
+
+    /**
+     * @brief Amount of GPIO reads of all snapshots that were answered by the snapshot
+     */
+    static uint32_t avoidedReads_;
+
+   public:
+    /**
+     * @brief Construct a new GPIOSnapshot object without any values
+     */
+    GPIOSnapshot();
+
+    /**
+     * @brief Construct a new GPIOSnapshot object with the values of a sampler.
+     *        Only GPIOs without a sampled value are read from the hardware
+     *
+     * @param sampler The sampler
+     */
+    GPIOSnapshot(const GPIOSampler &sampler);
+
+    /**
+     * @brief Get the value of a GPIO, reads it if it wasn't read yet.
+     *        The age GPIOIds get the age of the value in milliseconds
+     *
+     * @param id The GPIO ID
+     * @return u32 The value, 0 for GPIOId::None
+     */
+    u32 read(GPIOId id);
+
+    /**
+     * @brief Amount of GPIO reads of all snapshots
+     *
+     * @return uint32_t The amount
+     */
+    static uint32_t reads();
+
+    /**
+     * @brief Amount of GPIO reads of all snapshots that were answered by the snapshot
+     *
+     * @return uint32_t The amount
+     */
+    static uint32_t avoidedReads();
+};
+
+/**
+ * @brief The different kinds of keys in an expression
+ */
+enum class OperandType : uint8_t {
+    True,
+    False,
+    Number,
+    GPIO,
+};
+
+/**
+ * @brief A key of an expression
+ */
+class Operand {
+   public:
+    /**
+     * @brief The kind of the key
+     */
+    OperandType type;
+
+    /**
+     * @brief The number if it is a number, the GPIOId if it is a GPIO
+     */
+    u32 value;
+
+    /**
+     * @brief Construct a new `False` Operand object
+     */
+    Operand();
+
+    /**
+     * @brief Construct a new Operand object
+     *
+     * @param type The kind of the key
+     * @param value The number or the GPIOId, defaults to 0
+     */
+    Operand(OperandType type, u32 value = 0);
+
+    /**
+     * @brief Evaluates the key, reads the GPIO if it is one
+     *
+     * @param gpios The GPIO values of the render
+     * @return u32 The value of the key
+     */
+    u32 evaluate(GPIOSnapshot &gpios) const;
+};
+
+/**
+ * @brief The different formats of an expression
+ */
+enum class ExpressionType : uint8_t {
+    Value,
+    Equals,
+};
+
+/**
+ * @brief A parsed expression, `<key>` or `(<key> = <key>)`.
+ *        Scanned once and evaluated separately, so it can be evaluated again
+ *        without scanning the source
+ */
+class Expression {
+   public:
+    /**
+     * @brief The format of the expression
+     */
+    ExpressionType type;
+
+    /**
+     * @brief The first (or only) key
+     */
+    Operand left;
+
+    /**
+     * @brief The second key, only used for ExpressionType::Equals
+     */
+    Operand right;
+
+    /**
+     * @brief Construct a new `False` Expression object
+     */
+    Expression();
+
+    /**
+     * @brief Evaluates the expression with the current GPIO values
+     *
+     * @param gpios The GPIO values of the render
+     * @return bool The result
+     */
+    bool evaluate(GPIOSnapshot &gpios) const;
+
+    /**
+     * @brief Checks if the result doesn't depend on any GPIO
+     *
+     * @return bool Wether the expression is constant
+     */
+    bool isConstant() const;
+
+    /**
+     * @brief The GPIOs the expression reads
+     *
+     * @return u16 Bit mask of the GPIOIds, see `gpioBit()`
+     */
+    u16 gpios() const;
+};
+
+#endif  // GPIO_H
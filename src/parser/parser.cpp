@@ -1,116 +1,250 @@
 #include "parser.h"
 
-Parser::Parser(String inPath, String outPath, DoctypeDialect doctype) :
-    inPath_(inPath),
-    outPath_(outPath),
-    outFile_(),
-    doctype_(doctype),
-    scanner_(Scanner(inPath)),
-    tags_(std::vector<String>()),
-    addNewlineFor_(TextType::InnerText) {}
+#include <compiler/compiler.h>
 
-bool Parser::parse() {
-    // Open the output file
-    outFile_ = LittleFS.open(outPath_, "w");
-    if (!outFile_) {
-        Serial.printf(
-            "Error 2-1: Failed to open file for writing '%s'\n",
-            outPath_.c_str()
-        );
+bool ParserState::equals(const ParserState &state) const {
+    if (!scanner.equals(state.scanner) || doctype != state.doctype
+        || addNewlineFor != state.addNewlineFor
+        || tags != state.tags
+        || unknownTags.size() != state.unknownTags.size()) {
         return false;
     }
 
-    // Parse it
-    while (true) {
-        std::vector<Token> tokens = std::vector<Token>();
-        if (!scanner_.scanPart(tokens)) {
-            outFile_.close();
+    for (size_t i = 0; i < unknownTags.size(); i++) {
+        if (!unknownTags[i].equals(state.unknownTags[i])) {
             return false;
         }
-        Token token = nextToken(tokens);
+    }
 
-        // Handle indentation
-        if (token.type == TokenType::Indent) {
-            token = nextToken(tokens);
-        } else if (token.type == TokenType::Dedent) {
-            // Close the current level
-            closeTag();
+    return true;
+}
+
+bool Parser::tagValues_ = false;
 
-            // Close all dedented levels
-            while (token.type == TokenType::Dedent) {
-                closeTag();
-                token = nextToken(tokens);
+Parser::Parser(
+    String inPath,
+    Print &out,
+    GPIOSnapshot &gpios,
+    DoctypeDialect doctype
+) :
+    inPath_(inPath),
+    out_(&out),
+    gpios_(&gpios),
+    compiler_(nullptr),
+    doctype_(doctype),
+    scanner_(Scanner(inPath, gpios)),
+    tags_(ArenaVector<TagId>()),
+    unknownTags_(ArenaVector<SourceString>()),
+    addNewlineFor_(TextType::InnerText),
+    include_(),
+    depth_(0),
+    endsAfterInclude_(false) {}
+
+Parser::Parser(String inPath, Compiler &compiler, DoctypeDialect doctype) :
+    inPath_(inPath),
+    out_(&compiler.output()),
+    gpios_(nullptr),
+    compiler_(&compiler),
+    doctype_(doctype),
+    scanner_(Scanner(inPath, compiler)),
+    tags_(ArenaVector<TagId>()),
+    unknownTags_(ArenaVector<SourceString>()),
+    addNewlineFor_(TextType::InnerText),
+    include_(),
+    depth_(0),
+    endsAfterInclude_(false) {}
+
+bool Parser::parse() {
+    // The last parser is the one of the included file that is parsed right now
+    ArenaVector<Parser *> parsers = ArenaVector<Parser *>(1, this);
+    while (!parsers.empty()) {
+        Parser *parser = parsers.back();
+
+        bool done = false;
+        if (!parser->parsePart(done)) {
+            // Every included file on the stack failed
+            for (size_t i = parsers.size() - 1; i > 0; i--) {
+                log().printf_P(
+                    PSTR("Error 2-6: Failed to parse included file '%s'\n"),
+                    parsers[i]->inPath_.c_str()
+                );
             }
-        } else if (token.type != TokenType::EndOfPart
-                   && token.type != TokenType::EndOfSource) {
-            // Close the current level
+            return false;
+        }
+
+        if (parser->include_ != nullptr) {
+            // Parse the included file before the next part
+            parsers.push_back(parser->include_.get());
+        } else if (done) {
+            // Continue with the including file
+            parsers.pop_back();
+            if (!parsers.empty()) {
+                parsers.back()->include_.reset();
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Parser::parsePart(bool &done) {
+    // The included file at the end of the source was parsed
+    if (endsAfterInclude_) {
+        while (!tags_.empty()) {
             closeTag();
         }
 
-        // Parse the main token
-        switch (token.type) {
-            case TokenType::Doctype:
-                parseDoctype(token.doctype);
-                token = nextToken(tokens);
-                break;
-            case TokenType::Tag:
-                parseTag(token.tag);
-                token = nextToken(tokens);
-                break;
-            case TokenType::Text:
-                parseText(token.text);
-                token = nextToken(tokens);
-                break;
-            case TokenType::Comment:
-                parseComment(token.comment);
-                token = nextToken(tokens);
-                break;
-            case TokenType::Include:
-                if (!parseInclude(token.include)) {
-                    outFile_.close();
-                    return false;
-                }
-                token = nextToken(tokens);
-                break;
-            default:
-                break;
+        done = true;
+        return true;
+    }
+
+    if (!scanner_.scanPart()) {
+        return false;
+    }
+    Token token = scanner_.nextToken();
+
+    // Handle indentation
+    if (token.type == TokenType::Indent) {
+        token = scanner_.nextToken();
+    } else if (token.type == TokenType::Dedent) {
+        // Close the current level
+        closeTag();
+
+        // Close all dedented levels
+        while (token.type == TokenType::Dedent) {
+            closeTag();
+            token = scanner_.nextToken();
         }
+    } else if (token.type != TokenType::EndOfPart
+               && token.type != TokenType::EndOfSource) {
+        // Close the current level
+        closeTag();
+    }
 
-        // Handle the end token
-        if (token.type == TokenType::EndOfSource) {
-            // Close remaining tags
-            while (!tags_.empty()) {
-                closeTag();
+    // Parse the main token
+    switch (token.type) {
+        case TokenType::Doctype:
+            parseDoctype(token.doctype());
+            token = scanner_.nextToken();
+            break;
+        case TokenType::Tag:
+            parseTag(token.tag());
+            token = scanner_.nextToken();
+            break;
+        case TokenType::Text:
+            parseText(token.text());
+            token = scanner_.nextToken();
+            break;
+        case TokenType::Comment:
+            parseComment(token.comment());
+            token = scanner_.nextToken();
+            break;
+        case TokenType::Include:
+            if (!parseInclude(token.include())) {
+                return false;
             }
+            token = scanner_.nextToken();
 
-            // End the loop
+            // The remaining tags are closed after the included file was parsed
+            if (include_ != nullptr && token.type == TokenType::EndOfSource
+                && !scanner_.hasTokens()) {
+                endsAfterInclude_ = true;
+                return true;
+            }
+            break;
+        default:
             break;
-        } else if (token.type != TokenType::EndOfPart || tokens.size() > 0) {
-            outFile_.close();
-            Serial.printf("Error 2-2: unexpected token\n");
-            return false;
-        }
     }
 
-    // Close the output file
-    outFile_.close();
+    // Handle the end token
+    if (token.type == TokenType::EndOfSource) {
+        // Close remaining tags
+        while (!tags_.empty()) {
+            closeTag();
+        }
+
+        done = true;
+    } else if (token.type != TokenType::EndOfPart || scanner_.hasTokens()) {
+        log().printf_P(PSTR("Error 2-2: unexpected token\n"));
+        return false;
+    }
 
     return true;
 }
 
-Token Parser::nextToken(std::vector<Token> &tokens) {
-    Token token = tokens.front();
-    tokens.erase(tokens.begin());
-    return token;
+ParserState Parser::state() {
+    ParserState state = ParserState();
+    state.scanner = scanner_.state();
+    state.doctype = doctype_;
+    state.tags = tags_;
+    state.unknownTags = unknownTags_;
+    state.addNewlineFor = addNewlineFor_;
+    return state;
+}
+
+void Parser::restore(const ParserState &state) {
+    scanner_.restore(state.scanner);
+    doctype_ = state.doctype;
+    tags_ = state.tags;
+    unknownTags_ = state.unknownTags;
+    addNewlineFor_ = state.addNewlineFor;
+}
+
+void Parser::setTagValues(bool tagValues) {
+    tagValues_ = tagValues;
 }
 
-bool Parser::isVoidElement(String tag) {
-    return (
-        tag == "area" || tag == "base" || tag == "br" || tag == "col"
-        || tag == "embed" || tag == "hr" || tag == "img" || tag == "input"
-        || tag == "link" || tag == "meta" || tag == "param" || tag == "source"
-        || tag == "track" || tag == "wbr"
-    );
+bool Parser::tagValues() {
+    return tagValues_;
+}
+
+Print &Parser::log() {
+    if (compiler_ != nullptr) {
+        return compiler_->log();
+    }
+
+    return Serial;
+}
+
+void Parser::print(const SourceString &value) {
+    out_->write((const uint8_t *)value.data(), value.length());
+}
+
+void Parser::print(
+    const SourceString &value,
+    const ArenaVector<Interpolation> &interpolations,
+    TagId tag
+) {
+    // A span would be shown as text in raw text elements
+    bool wrapValues = tagValues_ && !isRawTextTag(tag);
+
+    size_t start = 0;
+    for (const Interpolation &interpolation : interpolations) {
+        out_->write(
+            (const uint8_t *)value.data() + start,
+            interpolation.offset - start
+        );
+        start = interpolation.offset;
+
+        if (wrapValues) {
+            out_->print(F("<span data-io=\""));
+            out_->print(gpioKey(interpolation.id));
+            out_->print(F("\">"));
+        }
+
+        // The value is left to the program while compiling
+        if (compiler_ != nullptr) {
+            compiler_->value(interpolation.id);
+        } else {
+            out_->print(gpios_->read(interpolation.id));
+        }
+
+        if (wrapValues) {
+            out_->print(F("</span>"));
+        }
+    }
+
+    out_->write((const uint8_t *)value.data() + start, value.length() - start);
 }
 
 void Parser::closeTag() {
@@ -118,11 +252,17 @@ void Parser::closeTag() {
         return;
     }
 
-    String tag = tags_.back();
+    TagId tag = tags_.back();
     tags_.pop_back();
 
-    if (tag != "") {
-        outFile_.printf("</%s>", tag.c_str());
+    if (tag == AALEC_PUG_TAG_UNKNOWN) {
+        out_->print(F("</"));
+        print(unknownTags_.back());
+        out_->print('>');
+        unknownTags_.pop_back();
+        handleTextNewline();
+    } else if (tag != AALEC_PUG_TAG_NONE) {
+        out_->print(FPSTR(closingTag(tag)));
         handleTextNewline();
     }
 }
@@ -130,7 +270,7 @@ void Parser::closeTag() {
 void Parser::handleTextNewline(TextType textType) {
     if (textType != TextType::InnerText) {
         if (addNewlineFor_ == textType) {
-            outFile_.print('\n');
+            out_->print('\n');
         } else {
             addNewlineFor_ = textType;
         }
@@ -139,7 +279,7 @@ void Parser::handleTextNewline(TextType textType) {
     }
 }
 
-void Parser::parseDoctype(DoctypeData data) {
+void Parser::parseDoctype(const DoctypeData &data) {
     // Handle the pipe newline
     handleTextNewline();
 
@@ -157,144 +297,182 @@ void Parser::parseDoctype(DoctypeData data) {
                 break;
         }
     } else {
-        Serial.printf("Error 2-3: doctype already set\n");
+        log().printf_P(PSTR("Error 2-3: doctype already set\n"));
     }
 
     // Append the HTML to the output
-    outFile_.print(data.toHTMLString());
+    data.print(*out_);
 
-    tags_.push_back("");
+    tags_.push_back(AALEC_PUG_TAG_NONE);
 }
 
-void Parser::parseTag(TagData data) {
+void Parser::parseTag(const TagData &data) {
     // Handle the pipe newline
     handleTextNewline();
 
     // Open the tag
-    outFile_.printf("<%s", data.name.c_str());
+    out_->print('<');
+    print(data.name);
 
     // Add attributes
-    for (Attribute attribute : data.attributes) {
+    for (const Attribute &attribute : data.attributes) {
         // Add the attribute
-        outFile_.printf(" %s", attribute.key.c_str());
+        out_->print(' ');
+        print(attribute.key);
         if (attribute.booleanAttribute && doctype_ != DoctypeDialect::HTML) {
-            outFile_.printf("=\"%s\"", attribute.key.c_str());
+            out_->print(F("=\""));
+            print(attribute.key);
+            out_->print('"');
         } else if (!attribute.booleanAttribute) {
-            outFile_.printf("=\"%s\"", attribute.value.c_str());
+            out_->print(F("=\""));
+            print(attribute.value);
+            out_->print('"');
         }
     }
 
+    // Tags without a name aren't closed
+    TagId tag = data.name.isEmpty()
+        ? AALEC_PUG_TAG_NONE
+        : tagId(data.name.data(), data.name.length());
+
     // (Forced) void element?
     if (data.isVoidElement) {
-        outFile_.print("/>");
+        out_->print(F("/>"));
 
-        tags_.push_back("");
-    } else if (isVoidElement(data.name)) {
+        tags_.push_back(AALEC_PUG_TAG_NONE);
+    } else if (isVoidTag(tag)) {
         switch (doctype_) {
             case DoctypeDialect::HTML:
-                outFile_.print(">");
+                out_->print('>');
                 break;
             case DoctypeDialect::XML:
-                outFile_.printf("></%s>", data.name.c_str());
+                out_->print('>');
+                out_->print(FPSTR(closingTag(tag)));
                 break;
             case DoctypeDialect::None:
-                outFile_.print("/>");
+                out_->print(F("/>"));
         }
 
-        tags_.push_back("");
+        tags_.push_back(AALEC_PUG_TAG_NONE);
     } else {
-        outFile_.printf(">%s", data.text.c_str());
-        tags_.push_back(data.name);
+        out_->print('>');
+        print(data.text, data.interpolations, tag);
+
+        // Only the names of unknown tags are kept
+        tags_.push_back(tag);
+        if (tag == AALEC_PUG_TAG_UNKNOWN) {
+            unknownTags_.push_back(data.name);
+        }
     }
 }
 
-void Parser::parseText(TextData data) {
+void Parser::parseText(const TextData &data) {
     // Handle the pipe newline
     handleTextNewline(data.textType);
 
-    // Add the text to the output
-    outFile_.print(data.value.c_str());
+    // Add the text to the output, its tag is the last one that is still open
+    TagId tag = AALEC_PUG_TAG_NONE;
+    for (size_t i = tags_.size(); i > 0 && tag == AALEC_PUG_TAG_NONE; i--) {
+        tag = tags_[i - 1];
+    }
+    print(data.value, data.interpolations, tag);
 
-    tags_.push_back("");
+    tags_.push_back(AALEC_PUG_TAG_NONE);
 }
 
-void Parser::parseComment(CommentData data) {
+void Parser::parseComment(const CommentData &data) {
     // Handle the pipe newline
     handleTextNewline();
 
     // Add the comment to the output
-    outFile_.printf("<!--%s-->", data.value.c_str());
+    out_->print(F("<!--"));
+    print(data.value);
+    out_->print(F("-->"));
 
-    tags_.push_back("");
+    tags_.push_back(AALEC_PUG_TAG_NONE);
 }
 
-bool Parser::parseInclude(IncludeData data) {
+bool Parser::parseInclude(const IncludeData &data) {
     // Handle the pipe newline
     handleTextNewline();
 
+    // Copy the path out of the source
+    String path = data.path.toString();
+
     // Get the directory path
-    String direcotryPath = data.path[0] != '/'
+    String direcotryPath = path[0] != '/'
         ? inPath_.substring(0, inPath_.lastIndexOf("/") + 1)
         : "";
 
     // Get the includeFilePath
-    String includeFilePath = direcotryPath + data.path;
+    String includeFilePath = direcotryPath + path;
 
     // Check for recursion
     if (includeFilePath == inPath_) {
-        Serial.printf(
-            "Error 2-4: Recursive include of '%s'\n",
+        log().printf_P(
+            PSTR("Error 2-4: Recursive include of '%s'\n"),
             includeFilePath.c_str()
         );
         return false;
     }
 
+    // Pug files are compiled into the program, other files are copied into
+    // the output when it is rendered
+    bool isPugFile = includeFilePath.length() > 5 && path.endsWith(".pug");
+    if (compiler_ != nullptr) {
+        if (!isPugFile) {
+            compiler_->include(includeFilePath);
+            tags_.push_back(AALEC_PUG_TAG_NONE);
+            return true;
+        }
+
+        compiler_->depend(includeFilePath);
+    }
+
     // Open the file
     File includeFile = LittleFS.open(includeFilePath, "r");
     if (!includeFile) {
-        Serial.printf(
-            "Error 2-5: Failed to open include file '%s'\n",
+        log().printf_P(
+            PSTR("Error 2-5: Failed to open include file '%s'\n"),
             includeFilePath.c_str()
         );
         return false;
     }
 
     // Parse the file if it is a pug file
-    if (includeFilePath.length() > 5 && data.path.endsWith(".pug")) {
+    if (isPugFile) {
         // Close the source file
         includeFile.close();
 
-        // Generate a path for the compiled file
-        String outFilePath = includeFilePath + ".html";
+        // Call the compiled file when the program is rendered
+        if (compiler_ != nullptr) {
+            compiler_->call(includeFilePath, doctype_);
+            tags_.push_back(AALEC_PUG_TAG_NONE);
+            return true;
+        }
 
-        // Parse the file
-        Parser parser(includeFilePath, outFilePath, doctype_);
-        if (!parser.parse()) {
-            Serial.printf(
-                "Error 2-6: Failed to parse included file '%s'\n",
+        // Limit the stack of included files
+        if (depth_ >= AALEC_PUG_MAX_INCLUDE_DEPTH) {
+            log().printf_P(
+                PSTR("Error 2-8: Includes are nested too deep at '%s'\n"),
                 includeFilePath.c_str()
             );
             return false;
         }
 
-        // Open, append, and close the compiled file
-        File outFile = LittleFS.open(outFilePath, "r");
-        if (!outFile.isFile()) {
-            Serial.printf(
-                "Error 2-7: Failed to open compiled file '%s'\n",
-                outFilePath.c_str()
-            );
-            return false;
-        }
-        outFile_.print(outFile.readString().c_str());
-        outFile.close();
+        // The file is parsed directly into the output before the next part,
+        // see `parse()`
+        include_.reset(
+            new Parser(includeFilePath, *out_, *gpios_, doctype_)
+        );
+        include_->depth_ = depth_ + 1;
     } else {
         // Append and close the file
-        outFile_.print(includeFile.readString().c_str());
+        Reader::copy(includeFile, *out_);
         includeFile.close();
     }
 
-    tags_.push_back("");
+    tags_.push_back(AALEC_PUG_TAG_NONE);
 
     return true;
 }
@@ -2,6 +2,15 @@
 #define PARSER_H
 
 #include <scanner/scanner.h>
+#include <tag/tag.h>
+
+/**
+ * @brief How deep included pug files can be nested.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_MAX_INCLUDE_DEPTH
+    #define AALEC_PUG_MAX_INCLUDE_DEPTH 16
+#endif
 
 /**
  * @brief The different doctypes that influence how the html gets outputted
@@ -12,25 +21,76 @@ enum class DoctypeDialect {
     XML,
 };
 
+/**
+ * @brief Everything the Parser keeps between two parts.
+ *        Restoring it continues parsing from that part again
+ */
+class ParserState {
+   public:
+    /**
+     * @brief State of the scanner
+     */
+    ScannerState scanner;
+
+    /**
+     * @brief The HTML dialect
+     */
+    DoctypeDialect doctype;
+
+    /**
+     * @brief Opened but not closed tags
+     */
+    ArenaVector<TagId> tags;
+
+    /**
+     * @brief Names of the opened but not closed unknown tags
+     */
+    ArenaVector<SourceString> unknownTags;
+
+    /**
+     * @brief Wheter there should be a new line before the tag if it is this text type
+     */
+    TextType addNewlineFor;
+
+    /**
+     * @brief Compare the state to another state
+     *
+     * @param state The state that is being compared
+     * @return bool If the states match
+     */
+    bool equals(const ParserState &state) const;
+};
+
 /**
  * @brief Scanner class that parses a .pug file
  */
 class Parser {
    private:
+    /**
+     * @brief The host microbenchmarks (extras/benchmark) time the private
+     *        functions one by one
+     */
+    friend class MicroBenchmark;
+
     /**
      * @brief The path to the file that should be compiled
      */
     String inPath_;
 
     /**
-     * @brief The path to the output file
+     * @brief Where the HTML is written to, the output or the compiler
+     */
+    Print *out_;
+
+    /**
+     * @brief The GPIO values of the render, nullptr while compiling
      */
-    String outPath_;
+    GPIOSnapshot *gpios_;
 
     /**
-     * @brief The file to write the HTML to
+     * @brief The compiler if the source is compiled into a program, otherwise nullptr
      */
-    File outFile_;
+    Compiler *compiler_;
 
     /**
      * @brief The HTML dialect
@@ -43,52 +103,145 @@ class Parser {
     Scanner scanner_;
 
     /**
-     * @brief Opened but not closed tags
+     * @brief Opened but not closed tags, AALEC_PUG_TAG_NONE for parts
+     *        that aren't closed with a tag
+     */
+    ArenaVector<TagId> tags_;
+
+    /**
+     * @brief Names of the opened but not closed tags that aren't in the tag table,
+     *        one for each AALEC_PUG_TAG_UNKNOWN in `tags_`
      */
-    std::vector<String> tags_;
+    ArenaVector<SourceString> unknownTags_;
 
     /**
      * @brief Wheter there should be a new line before the tag if it is this text type
      */
     TextType addNewlineFor_;
 
+    /**
+     * @brief Parser of the included pug file that is parsed before the next part
+     */
+    std::unique_ptr<Parser> include_;
+
+    /**
+     * @brief How deep the source is included, 0 if it isn't included
+     */
+    int depth_;
+
+    /**
+     * @brief Wether the source ended right after the included pug file
+     */
+    bool endsAfterInclude_;
+
+    /**
+     * @brief Wether GPIO values in texts are wrapped in a span with their key,
+     *        see `setTagValues()`
+     */
+    static bool tagValues_;
+
    public:
     /**
      * @brief Construct a new Parser object
      *
      * @param inPath Path to the file that should be compiled
-     * @param outPath Path to the output file
+     * @param out Where the HTML is written to
+     * @param gpios The GPIO values of the render, shared with included files
+     * @param doctype The HTML dialect, defaults to no dialect (DoctypeDialect::None)
+     */
+    Parser(
+        String inPath,
+        Print &out,
+        GPIOSnapshot &gpios,
+        DoctypeDialect doctype = DoctypeDialect::None
+    );
+
+    /**
+     * @brief Construct a new Parser object that compiles the source into a program
+     *
+     * @param inPath Path to the file that should be compiled
+     * @param compiler The compiler that receives the HTML
      * @param doctype The HTML dialect, defaults to no dialect (DoctypeDialect::None)
      */
     Parser(
         String inPath,
-        String outPath,
+        Compiler &compiler,
         DoctypeDialect doctype = DoctypeDialect::None
     );
 
     /**
-     * @brief Parse the source
+     * @brief Parse the source.
+     *        Included pug files are parsed on a stack in between the parts,
+     *        their HTML is written directly to the output
      *
      * @return bool Wheter the parsing was successful, see serial output for errors
      */
     bool parse();
 
+    /**
+     * @brief Parse the next part of the source
+     *
+     * @param done Set to true when the end of the source was parsed
+     * @return bool Wheter the parsing was successful, see serial output for errors
+     */
+    bool parsePart(bool &done);
+
+    /**
+     * @brief Get the state between two parts
+     *
+     * @return ParserState The state
+     */
+    ParserState state();
+
+    /**
+     * @brief Continue parsing from a previous state
+     *
+     * @param state The state returned by `state()`
+     */
+    void restore(const ParserState &state);
+
+    /**
+     * @brief Set wether GPIO values in texts are wrapped in
+     *        `<span data-io="IO_...">`, so a page can update them in place
+     *
+     * @param tagValues Wether the values are wrapped, defaults to false
+     */
+    static void setTagValues(bool tagValues);
+
+    /**
+     * @brief Checks if GPIO values in texts are wrapped in a span
+     *
+     * @return bool Wether the values are wrapped
+     */
+    static bool tagValues();
+
    private:
     /**
-     * @brief Get the next (aka first) token from the vector and remove it
-     * @param tokens The vector of tokens
-     * @return Token The next token
+     * @brief Where errors are printed to, the serial output or the compiler
+     *
+     * @return Print& The output for errors
      */
-    Token nextToken(std::vector<Token> &tokens);
+    Print &log();
 
     /**
-     * @brief Whether the tag is a void element by default
-     *        eg: img, br
+     * @brief Append a source string to the output
      *
-     * @param tag The tag
-     * @return bool If it is a void element
+     * @param value The source string
      */
-    bool isVoidElement(String tag);
+    void print(const SourceString &value);
+
+    /**
+     * @brief Append a text with GPIO values to the output
+     *
+     * @param value The text
+     * @param interpolations The GPIO values in the text
+     * @param tag The tag that contains the text
+     */
+    void print(
+        const SourceString &value,
+        const ArenaVector<Interpolation> &interpolations,
+        TagId tag
+    );
 
     /**
      * @brief Close the last opened tag
@@ -107,28 +260,28 @@ class Parser {
      *
      * @param data The doctype data
      */
-    void parseDoctype(DoctypeData data);
+    void parseDoctype(const DoctypeData &data);
 
     /**
      * @brief Parse a Tag Token
      *
      * @param data The tag data
      */
-    void parseTag(TagData data);
+    void parseTag(const TagData &data);
 
     /**
      * @brief Parse a Text Token
      *
      * @param data The text data
      */
-    void parseText(TextData data);
+    void parseText(const TextData &data);
 
     /**
      * @brief Parse a Comment Token
      *
      * @param data The comment data
      */
-    void parseComment(CommentData data);
+    void parseComment(const CommentData &data);
 
     /**
      * @brief Parse a Include Token
@@ -136,7 +289,7 @@ class Parser {
      * @param data The include data
      * @return bool Wheter the parsing was successful, see serial output for errors
      */
-    bool parseInclude(IncludeData data);
+    bool parseInclude(const IncludeData &data);
 };
 
 #endif  // PARSER_H
@@ -0,0 +1,407 @@
+#include "program.h"
+
+#include <etag/etag.h>
+
+Dependency::Dependency() : path(), size(UINT32_MAX), lastWrite(0) {}
+
+Dependency::Dependency(String path) :
+    path(path),
+    size(UINT32_MAX),
+    lastWrite(0) {
+    File file = LittleFS.open(path, "r");
+    if (file && file.isFile()) {
+        size = file.size();
+        lastWrite = file.getLastWrite();
+    }
+    file.close();
+}
+
+bool Dependency::equals(const Dependency &dependency) const {
+    return path == dependency.path && size == dependency.size
+        && lastWrite == dependency.lastWrite;
+}
+
+uint32_t Dependency::checksum() const {
+    File file = LittleFS.open(path, "r");
+    if (!file || !file.isFile()) {
+        return 0;
+    }
+
+    // The same hash as the ETags, on the host and on the device
+    ETag hash = ETag();
+    uint8_t buffer[64];
+    for (size_t length = file.read(buffer, sizeof(buffer)); length > 0;
+         length = file.read(buffer, sizeof(buffer))) {
+        hash.add(buffer, length);
+    }
+    file.close();
+
+    return hash.hash();
+}
+
+Routine::Routine() : path(), label(0) {}
+
+Routine::Routine(String path, uint16_t label) : path(path), label(label) {}
+
+CallFrame::CallFrame(uint16_t routine) : routine(routine), position(0) {}
+
+Program::Program() :
+    path_(),
+    reader_(),
+    interpreted_(false),
+    gpios_(0),
+    decisionGpios_(0),
+    dependencies_(std::vector<Dependency>()),
+    copies_(std::vector<String>()),
+    routines_(std::vector<Routine>()),
+    labels_(std::vector<uint32_t>()) {}
+
+String Program::pathFor(String inPath) {
+    return inPath + ".prg";
+}
+
+bool Program::load(String inPath) {
+    path_ = pathFor(inPath);
+    dependencies_.clear();
+    copies_.clear();
+    routines_.clear();
+    labels_.clear();
+
+    if (!reader_.open(path_)) {
+        return false;
+    }
+
+    // Check the header
+    if (!reader_.startsWith("APUG")
+        || reader_.peek(4) != AALEC_PUG_PROGRAM_VERSION) {
+        return false;
+    }
+    interpreted_ = reader_.peek(5) & 1;
+    bool precompiled = reader_.peek(5) & 4;
+
+    // Compile again if the values should be wrapped differently
+    if (((reader_.peek(5) & 2) != 0) != Parser::tagValues()) {
+        return false;
+    }
+
+    // Find the table
+    size_t size = reader_.size();
+    if (size < 10) {
+        return false;
+    }
+    reader_.seek(size - 4);
+    uint32_t tableStart = readU32();
+    if (tableStart < 6 || tableStart > size - 4) {
+        return false;
+    }
+    reader_.seek(tableStart);
+
+    // Read the table
+    gpios_ = readU16();
+    decisionGpios_ = readU16();
+
+    uint16_t dependencyCount = readU16();
+    std::vector<uint32_t> timePositions = std::vector<uint32_t>();
+    for (uint16_t i = 0; i < dependencyCount; i++) {
+        Dependency dependency = Dependency();
+        dependency.path = readString();
+        dependency.size = readU32();
+        timePositions.push_back(reader_.position());
+        dependency.lastWrite = readU32();
+        dependencies_.push_back(dependency);
+    }
+
+    uint16_t copyCount = readU16();
+    for (uint16_t i = 0; i < copyCount; i++) {
+        copies_.push_back(readString());
+    }
+
+    uint16_t routineCount = readU16();
+    for (uint16_t i = 0; i < routineCount; i++) {
+        Routine routine = Routine();
+        routine.label = readU16();
+        routine.path = readString();
+        routines_.push_back(routine);
+    }
+
+    uint16_t labelCount = readU16();
+    for (uint16_t i = 0; i < labelCount; i++) {
+        labels_.push_back(readU32());
+    }
+
+    // The table must end right before its position
+    if (reader_.position() != size - 4
+        || (!interpreted_ && routines_.empty())) {
+        return false;
+    }
+
+    // The times of files uploaded to the device don't match the host
+    if (precompiled) {
+        return adopt(timePositions);
+    }
+
+    // Compile again if any of the files changed. Files written in the same
+    // second as the program might have changed without a new time. Later
+    // times don't count, the clock of the device might not be set
+    Dependency program = Dependency(path_);
+    for (const Dependency &dependency : dependencies_) {
+        if (!Dependency(dependency.path).equals(dependency)
+            || (dependency.lastWrite != 0
+                && dependency.lastWrite == program.lastWrite)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Program::isInterpreted() {
+    return interpreted_;
+}
+
+u16 Program::gpios() {
+    return gpios_;
+}
+
+u16 Program::decisionGpios() {
+    return decisionGpios_;
+}
+
+const std::vector<Dependency> &Program::dependencies() {
+    return dependencies_;
+}
+
+const std::vector<String> &Program::copies() {
+    return copies_;
+}
+
+bool Program::render(Print &out, GPIOSnapshot &gpios) {
+    // The rendered routines are kept on a stack instead of rendering
+    // included files recursively, the last one is rendered right now
+    std::vector<CallFrame> frames = std::vector<CallFrame>();
+    frames.reserve(AALEC_PUG_MAX_INCLUDE_DEPTH + 1);
+    if (routines_.empty() || !jump(routines_[0].label)) {
+        printErrorInvalid();
+        return false;
+    }
+    frames.push_back(CallFrame(0));
+
+    while (true) {
+        switch ((Op)reader_.read()) {
+            case Op::Static:
+                copy(readU16(), out);
+                break;
+            case Op::Value:
+                out.print(gpios.read((GPIOId)reader_.read()));
+                break;
+            case Op::Branch: {
+                Expression expression = readExpression();
+                uint16_t label = readU16();
+                if (!expression.evaluate(gpios) && !jump(label)) {
+                    printErrorInvalid();
+                    printErrorCalls(frames);
+                    return false;
+                }
+                break;
+            }
+            case Op::Jump:
+                if (!jump(readU16())) {
+                    printErrorInvalid();
+                    printErrorCalls(frames);
+                    return false;
+                }
+                break;
+            case Op::Call:
+                if (!call(readU16(), frames)) {
+                    printErrorCalls(frames);
+                    return false;
+                }
+                break;
+            case Op::Include:
+                if (!include(readString(), out)) {
+                    printErrorCalls(frames);
+                    return false;
+                }
+                break;
+            case Op::Log:
+                copy(readU16(), Serial);
+                break;
+            case Op::End:
+                if (reader_.read() != 1) {
+                    printErrorCalls(frames);
+                    return false;
+                }
+
+                // Continue after the call once the routine is done
+                frames.pop_back();
+                if (frames.empty()) {
+                    return true;
+                }
+                reader_.seek(frames.back().position);
+                break;
+            default:
+                printErrorInvalid();
+                printErrorCalls(frames);
+                return false;
+        }
+    }
+}
+
+bool Program::call(uint16_t routine, std::vector<CallFrame> &frames) {
+    // Continue after the call once the routine is done
+    frames.back().position = reader_.position();
+
+    if (routine >= routines_.size()) {
+        printErrorInvalid();
+        return false;
+    }
+    frames.push_back(CallFrame(routine));
+
+    // Same limit and error as the Parser, the source is the first frame
+    if (frames.size() > AALEC_PUG_MAX_INCLUDE_DEPTH + 1) {
+        Serial.printf_P(
+            PSTR("Error 2-8: Includes are nested too deep at '%s'\n"),
+            routines_[routine].path.c_str()
+        );
+        return false;
+    }
+
+    if (!jump(routines_[routine].label)) {
+        printErrorInvalid();
+        return false;
+    }
+
+    return true;
+}
+
+bool Program::adopt(const std::vector<uint32_t> &positions) {
+    // Compile again if any of the files isn't the one it was compiled from
+    for (Dependency &dependency : dependencies_) {
+        Dependency file = Dependency(dependency.path);
+        if (file.size != dependency.size
+            || file.checksum() != dependency.lastWrite) {
+            return false;
+        }
+        dependency.lastWrite = file.lastWrite;
+    }
+
+    // Replace the checksums with the times, the flag goes last so a failed
+    // write only means the files are checked again on the next load
+    reader_.close();
+    File program = LittleFS.open(path_, "r+");
+    if (program) {
+        bool written = true;
+        for (size_t i = 0; i < dependencies_.size() && written; i++) {
+            uint32_t time = dependencies_[i].lastWrite;
+            uint8_t bytes[4] = {
+                (uint8_t)time,
+                (uint8_t)(time >> 8),
+                (uint8_t)(time >> 16),
+                (uint8_t)(time >> 24),
+            };
+            written = program.seek(positions[i], SeekSet)
+                && program.write(bytes, sizeof(bytes)) == sizeof(bytes);
+        }
+
+        uint8_t flags = (interpreted_ ? 1 : 0) | (Parser::tagValues() ? 2 : 0);
+        if (written && program.seek(5, SeekSet)) {
+            program.write(flags);
+        }
+        program.close();
+    }
+
+    return reader_.open(path_);
+}
+
+bool Program::include(String path, Print &out) {
+    // Open the file
+    File includeFile = LittleFS.open(path, "r");
+    if (!includeFile) {
+        Serial.printf_P(
+            PSTR("Error 2-5: Failed to open include file '%s'\n"),
+            path.c_str()
+        );
+        return false;
+    }
+
+    // Append and close the file
+    Reader::copy(includeFile, out);
+    includeFile.close();
+
+    return true;
+}
+
+bool Program::jump(uint16_t label) {
+    if (label >= labels_.size()) {
+        return false;
+    }
+
+    reader_.seek(labels_[label]);
+    return true;
+}
+
+void Program::copy(size_t length, Print &out) {
+    while (length > 0) {
+        // Refill the buffer if everything buffered was copied
+        if (reader_.buffered() == 0 && reader_.peek() == -1) {
+            return;
+        }
+
+        size_t amount = length < reader_.buffered() ? length
+                                                    : reader_.buffered();
+        out.write((const uint8_t *)reader_.current(), amount);
+        reader_.skip(amount);
+        length -= amount;
+    }
+}
+
+uint16_t Program::readU16() {
+    uint16_t value = reader_.read() & 0xFF;
+    value |= (reader_.read() & 0xFF) << 8;
+    return value;
+}
+
+uint32_t Program::readU32() {
+    uint32_t value = readU16();
+    value |= (uint32_t)readU16() << 16;
+    return value;
+}
+
+String Program::readString() {
+    uint16_t length = readU16();
+
+    String value = String();
+    value.reserve(length);
+    for (uint16_t i = 0; i < length; i++) {
+        value.concat((char)reader_.read());
+    }
+
+    return value;
+}
+
+Expression Program::readExpression() {
+    Expression expression = Expression();
+    expression.type = (ExpressionType)reader_.read();
+    expression.left.type = (OperandType)reader_.read();
+    expression.left.value = readU32();
+    expression.right.type = (OperandType)reader_.read();
+    expression.right.value = readU32();
+    return expression;
+}
+
+void Program::printErrorCalls(const std::vector<CallFrame> &frames) {
+    // Every included file on the stack failed, the source itself isn't included
+    for (size_t i = frames.size() - 1; i > 0; i--) {
+        Serial.printf_P(
+            PSTR("Error 2-6: Failed to parse included file '%s'\n"),
+            routines_[frames[i].routine].path.c_str()
+        );
+    }
+}
+
+void Program::printErrorInvalid() {
+    Serial.printf_P(
+        PSTR("Error 3-1: Invalid program '%s'\n"),
+        path_.c_str()
+    );
+}
@@ -0,0 +1,362 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <gpio/gpio.h>
+#include <parser/parser.h>
+#include <reader/reader.h>
+
+/**
+ * @brief Version of the program file format.
+ *        Programs with another version are compiled again
+ */
+#define AALEC_PUG_PROGRAM_VERSION 5
+
+/**
+ * @brief The instructions of a program.
+ *        Operands follow the instruction, numbers are little endian:
+ *        - Static: u16 length, bytes -> write the bytes
+ *        - Value: u8 GPIOId -> write the value of the GPIO
+ *        - Branch: expression, u16 label -> jump to the label if the expression is false
+ *        - Jump: u16 label -> jump to the label
+ *        - Call: u16 routine -> render the routine of an included pug file
+ *        - Include: u16 length, path -> copy a plain included file
+ *        - Log: u16 length, bytes -> print the bytes to the serial output
+ *        - End: u8 success -> end the routine
+ *
+ *        An expression is: u8 ExpressionType, u8 OperandType, u32 value, u8 OperandType, u32 value
+ */
+enum class Op : uint8_t {
+    Static,
+    Value,
+    Branch,
+    Jump,
+    Call,
+    Include,
+    Log,
+    End,
+};
+
+/**
+ * @brief A file a program was compiled from
+ */
+class Dependency {
+   public:
+    /**
+     * @brief Path to the file
+     */
+    String path;
+
+    /**
+     * @brief Size of the file, UINT32_MAX if it didn't exist
+     */
+    uint32_t size;
+
+    /**
+     * @brief Time of the last write to the file
+     */
+    uint32_t lastWrite;
+
+    /**
+     * @brief Construct a new empty Dependency object
+     */
+    Dependency();
+
+    /**
+     * @brief Construct a new Dependency object with the current size and time of a file
+     *
+     * @param path Path to the file
+     */
+    Dependency(String path);
+
+    /**
+     * @brief Compare the dependency to another dependency
+     *
+     * @param dependency The dependency that is being compared
+     * @return bool If the path, size and time match
+     */
+    bool equals(const Dependency &dependency) const;
+
+    /**
+     * @brief Checksum of the content of the file (the hash of `ETag`),
+     *        identifies the file independent of its time
+     *
+     * @return uint32_t The checksum, 0 if the file doesn't exist
+     */
+    uint32_t checksum() const;
+};
+
+/**
+ * @brief A compiled pug file in a program, the first one is the compiled source,
+ *        the others are included pug files
+ */
+class Routine {
+   public:
+    /**
+     * @brief Path to the pug file
+     */
+    String path;
+
+    /**
+     * @brief Label of the first instruction
+     */
+    uint16_t label;
+
+    /**
+     * @brief Construct a new empty Routine object
+     */
+    Routine();
+
+    /**
+     * @brief Construct a new Routine object
+     *
+     * @param path Path to the pug file
+     * @param label Label of the first instruction
+     */
+    Routine(String path, uint16_t label);
+};
+
+/**
+ * @brief A routine that is rendered right now
+ */
+class CallFrame {
+   public:
+    /**
+     * @brief Index of the routine
+     */
+    uint16_t routine;
+
+    /**
+     * @brief Position to continue at once the called routine is done
+     */
+    uint32_t position;
+
+    /**
+     * @brief Construct a new CallFrame object
+     *
+     * @param routine Index of the routine
+     */
+    CallFrame(uint16_t routine);
+};
+
+/**
+ * @brief A pug file compiled into instructions, stored next to the source.
+ *        Rendering it only reads the GPIOs and writes the HTML,
+ *        the source is scanned and parsed once by the Compiler.
+ *
+ *        File format:
+ *        - Header: "APUG", u8 version, u8 flags (1: the source couldn't be compiled,
+ *                  2: GPIO values are wrapped in a span, see `Parser::setTagValues()`,
+ *                  4: compiled on a host, the times of the dependencies are checksums)
+ *        - Instructions, see `Op`
+ *        - Table: u16 bit mask of the GPIOs the program reads, see `gpioBit()`
+ *                 u16 bit mask of the GPIOs expressions read
+ *                 u16 amount of dependencies, each: u16 length, path, u32 size, u32 time
+ *                 u16 amount of copied plain files, each: u16 length, path
+ *                 u16 amount of routines, each: u16 label, u16 length, path
+ *                 u16 amount of labels, each: u32 position in the file
+ *        - u32 position of the table in the file
+ */
+class Program {
+   private:
+    /**
+     * @brief Path to the program file
+     */
+    String path_;
+
+    /**
+     * @brief Reader for the program file
+     */
+    Reader reader_;
+
+    /**
+     * @brief Wether the source couldn't be compiled and must be rendered by the Parser
+     */
+    bool interpreted_;
+
+    /**
+     * @brief Bit mask of the GPIOs the program reads, see `gpioBit()`
+     */
+    u16 gpios_;
+
+    /**
+     * @brief Bit mask of the GPIOs expressions read, see `gpioBit()`
+     */
+    u16 decisionGpios_;
+
+    /**
+     * @brief The files the program was compiled from
+     */
+    std::vector<Dependency> dependencies_;
+
+    /**
+     * @brief The plain files that are copied into the output
+     */
+    std::vector<String> copies_;
+
+    /**
+     * @brief The compiled pug files
+     */
+    std::vector<Routine> routines_;
+
+    /**
+     * @brief Positions of the labels in the file
+     */
+    std::vector<uint32_t> labels_;
+
+   public:
+    /**
+     * @brief Construct a new empty Program object
+     */
+    Program();
+
+    /**
+     * @brief Get the path of the program file for a source
+     *
+     * @param inPath Path to the pug file
+     * @return String Path to the program file
+     */
+    static String pathFor(String inPath);
+
+    /**
+     * @brief Load the program of a source
+     *
+     * @param inPath Path to the pug file
+     * @return bool Wether there is a valid program that is up to date with its dependencies
+     */
+    bool load(String inPath);
+
+    /**
+     * @brief Checks if the source couldn't be compiled and must be rendered by the Parser
+     *
+     * @return bool Wether the source must be rendered by the Parser
+     */
+    bool isInterpreted();
+
+    /**
+     * @brief The GPIOs the source and its included files read.
+     *        All bits are set if the source couldn't be compiled
+     *
+     * @return u16 Bit mask of the GPIOIds, see `gpioBit()`
+     */
+    u16 gpios();
+
+    /**
+     * @brief The GPIOs expressions of the source and its included files read,
+     *        they decide which parts are shown.
+     *        All bits are set if the source couldn't be compiled
+     *
+     * @return u16 Bit mask of the GPIOIds, see `gpioBit()`
+     */
+    u16 decisionGpios();
+
+    /**
+     * @brief The files the program was compiled from
+     *
+     * @return const std::vector<Dependency>& The files
+     */
+    const std::vector<Dependency> &dependencies();
+
+    /**
+     * @brief The plain files that are copied into the output on every render,
+     *        they aren't checked by `load()`
+     *
+     * @return const std::vector<String>& Paths to the files
+     */
+    const std::vector<String> &copies();
+
+    /**
+     * @brief Render the HTML with the current GPIO values
+     *
+     * @param out Where the HTML is written to
+     * @param gpios The GPIO values of the render
+     * @return bool Wheter rendering was successful, see serial output for errors
+     */
+    bool render(Print &out, GPIOSnapshot &gpios);
+
+   private:
+    /**
+     * @brief Start rendering a routine of an included file
+     *
+     * @param routine Index of the routine
+     * @param frames The routines that are rendered right now, the last one calls
+     * @return bool Wheter the routine exists, see serial output for errors
+     */
+    bool call(uint16_t routine, std::vector<CallFrame> &frames);
+
+    /**
+     * @brief Take over a program that was compiled on a host. If the files
+     *        match the checksums, their times replace the checksums in the
+     *        program file, later loads only compare the times
+     *
+     * @param positions Positions of the times of the dependencies in the file
+     * @return bool Wether the files match the checksums
+     */
+    bool adopt(const std::vector<uint32_t> &positions);
+
+    /**
+     * @brief Copy a plain included file to the output
+     *
+     * @param path Path to the file
+     * @param out Where the HTML is written to
+     * @return bool Wheter the file could be opened, see serial output for errors
+     */
+    bool include(String path, Print &out);
+
+    /**
+     * @brief Jump to a label
+     *
+     * @param label The label
+     * @return bool Wether the label exists
+     */
+    bool jump(uint16_t label);
+
+    /**
+     * @brief Copy bytes from the program to an output
+     *
+     * @param length Amount of bytes
+     * @param out The output
+     */
+    void copy(size_t length, Print &out);
+
+    /**
+     * @brief Read an u16 from the program
+     *
+     * @return uint16_t The number
+     */
+    uint16_t readU16();
+
+    /**
+     * @brief Read an u32 from the program
+     *
+     * @return uint32_t The number
+     */
+    uint32_t readU32();
+
+    /**
+     * @brief Read a string with a leading u16 length from the program
+     *
+     * @return String The string
+     */
+    String readString();
+
+    /**
+     * @brief Read an expression from the program
+     *
+     * @return Expression The expression
+     */
+    Expression readExpression();
+
+    /**
+     * @brief Print that the routines that are rendered right now failed
+     *
+     * @param frames The routines that are rendered right now
+     */
+    void printErrorCalls(const std::vector<CallFrame> &frames);
+
+    /**
+     * @brief Prints the "Error 3-1: Invalid program '{path_}'" message
+     */
+    void printErrorInvalid();
+};
+
+#endif  // PROGRAM_H
@@ -0,0 +1,318 @@
+#include "reader.h"
+
+Reader::Reader() :
+    file_(),
+    buffer_(),
+    bufferStart_(0),
+    bufferLength_(0),
+    index_(0),
+    endOfFile_(false),
+    inMemory_(false),
+    lines_() {}
+
+bool Reader::open(String path) {
+    close();
+
+    file_ = LittleFS.open(path, "r");
+    if (!file_ || !file_.isFile()) {
+        file_.close();
+        return false;
+    }
+
+    // Load small files into memory as a whole
+    size_t size = file_.size();
+    if (size <= AALEC_PUG_IN_MEMORY_SOURCE_SIZE) {
+        buffer_.reset(new char[size > 0 ? size : 1]);
+        bufferLength_ = file_.read((uint8_t *)buffer_.get(), size);
+        endOfFile_ = true;
+        inMemory_ = true;
+
+        // The file isn't needed anymore
+        file_.close();
+
+        return true;
+    }
+
+    buffer_.reset(new char[AALEC_PUG_READER_BUFFER_SIZE]);
+
+    return true;
+}
+
+void Reader::close() {
+    file_.close();
+    buffer_.reset();
+    bufferStart_ = 0;
+    bufferLength_ = 0;
+    index_ = 0;
+    endOfFile_ = false;
+    inMemory_ = false;
+    lines_ = std::vector<Line>();
+}
+
+bool Reader::isOpen() {
+    return buffer_ != nullptr;
+}
+
+bool Reader::isInMemory() {
+    return inMemory_;
+}
+
+const char *Reader::current() {
+    return buffer_.get() + index_;
+}
+
+size_t Reader::buffered() {
+    return bufferLength_ - index_;
+}
+
+size_t Reader::size() {
+    return inMemory_ ? bufferLength_ : file_.size();
+}
+
+int Reader::peek(size_t offset) {
+    // Fast path, the character is already buffered
+    if (index_ + offset < bufferLength_ || fill(offset)) {
+        return (unsigned char)buffer_[index_ + offset];
+    }
+
+    // End of the file or the offset doesn't fit into the buffer
+    if (endOfFile_ || !isOpen()) {
+        return -1;
+    }
+
+    // Read the single character directly from the file and restore the file
+    // position afterwards (it must always be right after the buffered bytes)
+    file_.seek(bufferStart_ + index_ + offset, SeekSet);
+    int value = file_.read();
+    file_.seek(bufferStart_ + bufferLength_, SeekSet);
+
+    return value;
+}
+
+bool Reader::startsWith(const char *value, size_t offset) {
+    for (size_t i = 0;; i++) {
+        uint8_t expected = pgm_read_byte(value + i);
+        if (expected == '\0') {
+            break;
+        }
+        if (peek(offset + i) != expected) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int Reader::read() {
+    int value = peek();
+
+    if (value != -1) {
+        index_++;
+    }
+
+    return value;
+}
+
+void Reader::skip(size_t amount) {
+    if (index_ + amount <= bufferLength_) {
+        index_ += amount;
+    } else {
+        seek(position() + amount);
+    }
+}
+
+size_t Reader::position() {
+    return bufferStart_ + index_;
+}
+
+void Reader::seek(size_t position) {
+    // Rewind or advance inside the buffer
+    if (position >= bufferStart_ && position <= bufferStart_ + bufferLength_) {
+        index_ = position - bufferStart_;
+        return;
+    }
+
+    // The buffer holds the whole file, stop at its end
+    if (inMemory_) {
+        index_ = bufferLength_;
+        return;
+    }
+
+    // Drop the buffer and continue reading from the new position
+    file_.seek(position, SeekSet);
+    bufferStart_ = position;
+    bufferLength_ = 0;
+    index_ = 0;
+    endOfFile_ = false;
+}
+
+void Reader::skipLine() {
+    while (true) {
+        // Load the next part of the file if everything buffered was removed
+        if (index_ >= bufferLength_ && !fill(0)) {
+            return;
+        }
+
+        // Search the buffered characters for the '\n'
+        const char *start = buffer_.get() + index_;
+        const char *newline =
+            (const char *)memchr(start, '\n', bufferLength_ - index_);
+
+        if (newline != nullptr) {
+            index_ += newline - start;
+            return;
+        }
+
+        index_ = bufferLength_;
+    }
+}
+
+void Reader::skipIndentedLines(char indentationChar, int indentation) {
+    // The line index only knows about whitespace indentation
+    if (inMemory_ && (indentationChar == ' ' || indentationChar == '\t')) {
+        if (lines_.empty()) {
+            buildLines();
+        }
+
+        // Jump to the first following line that isn't indented enough
+        size_t line = findLine(position() + 1);
+        while (line < lines_.size()
+               && lines_[line].indentationChar == indentationChar
+               && lines_[line].indentation > indentation) {
+            line++;
+        }
+
+        // Stop at the '\n' before that line, or at the end of the last line
+        if (line < lines_.size()) {
+            index_ = lines_[line].start - 1;
+        } else if (bufferLength_ > 0 && buffer_[bufferLength_ - 1] == '\n') {
+            index_ = bufferLength_ - 1;
+        } else {
+            index_ = bufferLength_;
+        }
+
+        return;
+    }
+
+    while (peek() == '\n') {
+        // Count the indentation chars of the next line
+        int size = 0;
+        while (peek(1 + size) == indentationChar) {
+            size++;
+        }
+
+        if (size <= indentation) {
+            return;
+        }
+
+        // Remove the '\n' and the line
+        skip();
+        skipLine();
+    }
+}
+
+void Reader::copy(File &file, Print &out) {
+    uint8_t chunk[AALEC_PUG_READER_BUFFER_SIZE];
+
+    size_t read = 0;
+    while ((read = file.read(chunk, sizeof(chunk))) > 0) {
+        out.write(chunk, read);
+    }
+}
+
+bool Reader::fill(size_t offset) {
+    if (endOfFile_ || !isOpen()) {
+        return false;
+    }
+
+    // Move the unread bytes to the front of the buffer
+    if (index_ > 0) {
+        memmove(buffer_.get(), buffer_.get() + index_, bufferLength_ - index_);
+        bufferStart_ += index_;
+        bufferLength_ -= index_;
+        index_ = 0;
+    }
+
+    if (offset >= AALEC_PUG_READER_BUFFER_SIZE) {
+        return false;
+    }
+
+    // Fill the rest of the buffer
+    while (bufferLength_ <= offset) {
+        size_t read = file_.read(
+            (uint8_t *)buffer_.get() + bufferLength_,
+            AALEC_PUG_READER_BUFFER_SIZE - bufferLength_
+        );
+
+        if (read == 0) {
+            endOfFile_ = true;
+            return false;
+        }
+
+        bufferLength_ += read;
+    }
+
+    return true;
+}
+
+void Reader::buildLines() {
+    const char *buffer = buffer_.get();
+
+    // Count the lines first so the index is allocated only once
+    size_t count = 1;
+    for (const char *c = buffer;
+         (c = (const char *)memchr(c, '\n', buffer + bufferLength_ - c))
+         != nullptr;
+         c++) {
+        count++;
+    }
+    lines_.reserve(count);
+
+    size_t start = 0;
+    while (start < bufferLength_) {
+        // Count the leading indentation chars
+        Line line = Line();
+        line.start = start;
+        line.indentation = 0;
+        line.indentationChar = buffer[start] == ' ' || buffer[start] == '\t'
+            ? buffer[start]
+            : '\0';
+
+        while (line.indentationChar != '\0'
+               && start + line.indentation < bufferLength_
+               && buffer[start + line.indentation] == line.indentationChar
+               && line.indentation < UINT16_MAX) {
+            line.indentation++;
+        }
+
+        lines_.push_back(line);
+
+        // Continue after the next '\n'
+        const char *newline = (const char *)
+            memchr(buffer + start, '\n', bufferLength_ - start);
+        if (newline == nullptr) {
+            break;
+        }
+        start = newline - buffer + 1;
+    }
+}
+
+size_t Reader::findLine(size_t position) {
+    // Binary search, the lines are sorted by their start
+    size_t low = 0;
+    size_t high = lines_.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (lines_[middle].start < position) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < lines_.size() && lines_[low].start == position) {
+        return low;
+    }
+
+    return lines_.size();
+}
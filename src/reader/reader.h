@@ -0,0 +1,246 @@
+#ifndef READER_H
+#define READER_H
+
+#include <LittleFS.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Size of the read buffer of the Reader in bytes.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_READER_BUFFER_SIZE
+    #define AALEC_PUG_READER_BUFFER_SIZE 256
+#endif
+
+/**
+ * @brief Source files up to this size in bytes are loaded into memory as a whole,
+ *        so tokens can view into them instead of copying.
+ *        Can be overwritten with a build flag, 0 disables loading into memory
+ */
+#ifndef AALEC_PUG_IN_MEMORY_SOURCE_SIZE
+    #define AALEC_PUG_IN_MEMORY_SOURCE_SIZE 4096
+#endif
+
+/**
+ * @brief Info about a line of a source that is in memory
+ */
+class Line {
+   public:
+    /**
+     * @brief Position of the first character of the line
+     */
+    uint32_t start;
+
+    /**
+     * @brief Amount of leading indentation chars
+     */
+    uint16_t indentation;
+
+    /**
+     * @brief The leading indentation char, ' ' or '\t', '\0' if there is none
+     */
+    char indentationChar;
+};
+
+/**
+ * @brief Buffered reader for a source file.
+ *        Small files are loaded into memory as a whole, bigger files are kept
+ *        open until the reader is closed and are read through a fixed size buffer.
+ *        Reads, lookahead and rewinds are served from the buffer
+ */
+class Reader {
+   private:
+    /**
+     * @brief The file that is being read
+     */
+    File file_;
+
+    /**
+     * @brief The read buffer
+     */
+    std::unique_ptr<char[]> buffer_;
+
+    /**
+     * @brief Position in the file of the first byte in the buffer
+     */
+    size_t bufferStart_;
+
+    /**
+     * @brief Amount of valid bytes in the buffer
+     */
+    size_t bufferLength_;
+
+    /**
+     * @brief Index of the current byte in the buffer
+     */
+    size_t index_;
+
+    /**
+     * @brief Wether the end of the file was read into the buffer
+     */
+    bool endOfFile_;
+
+    /**
+     * @brief Wether the whole file was loaded into the buffer
+     */
+    bool inMemory_;
+
+    /**
+     * @brief Index of the lines if the file is in memory.
+     *        Built when it is needed for the first time
+     */
+    std::vector<Line> lines_;
+
+   public:
+    /**
+     * @brief Construct a new closed Reader object
+     */
+    Reader();
+
+    /**
+     * @brief Open a file for reading
+     *
+     * @param path Path to the file
+     * @return bool Wether the file could be opened
+     */
+    bool open(String path);
+
+    /**
+     * @brief Close the file and release the buffer
+     */
+    void close();
+
+    /**
+     * @brief Checks if a file is opened
+     *
+     * @return bool Wether a file is opened
+     */
+    bool isOpen();
+
+    /**
+     * @brief Checks if the whole file was loaded into memory.
+     *        If so, pointers returned by `current()` stay valid until the reader is closed
+     *
+     * @return bool Wether the whole file is in memory
+     */
+    bool isInMemory();
+
+    /**
+     * @brief Pointer to the current character in the buffer
+     *
+     * @return const char* The pointer
+     */
+    const char *current();
+
+    /**
+     * @brief Amount of characters that are left in the buffer
+     *
+     * @return size_t The amount
+     */
+    size_t buffered();
+
+    /**
+     * @brief The size of the file
+     *
+     * @return size_t The size in bytes
+     */
+    size_t size();
+
+    /**
+     * @brief Get a character without removing it
+     *
+     * @param offset Distance from the current position, defaults to 0
+     * @return int The character, -1 at the end of the file
+     */
+    int peek(size_t offset = 0);
+
+    /**
+     * @brief Compare the next part of the file to the given string
+     *
+     * @param value The string that is being compared, may be in flash (PROGMEM)
+     * @param offset Distance from the current position, defaults to 0
+     * @return bool If the strings match
+     */
+    bool startsWith(const char *value, size_t offset = 0);
+
+    /**
+     * @brief Get a character and remove it
+     *
+     * @return int The character, -1 at the end of the file
+     */
+    int read();
+
+    /**
+     * @brief Removes the specified amount of characters
+     *
+     * @param amount The amount of characters to remove, defaults to 1
+     */
+    void skip(size_t amount = 1);
+
+    /**
+     * @brief The current position in the file
+     *
+     * @return size_t The position
+     */
+    size_t position();
+
+    /**
+     * @brief Set the current position in the file.
+     *        Positions inside the buffer don't access the file
+     *
+     * @param position The new position
+     */
+    void seek(size_t position);
+
+    /**
+     * @brief Removes all characters up to the next '\n' (not included) or the end of the file
+     */
+    void skipLine();
+
+    /**
+     * @brief Removes all following lines that start with more than the given
+     *        amount of indentation chars, up to the '\n' of the last one.
+     *        Expects a '\n' at the beginning.
+     *        If the file is in memory this jumps over the lines using the line index
+     *
+     * @param indentationChar The indentation char
+     * @param indentation The amount of indentation chars
+     */
+    void skipIndentedLines(char indentationChar, int indentation);
+
+    /**
+     * @brief Copy the rest of a file to an output in chunks of the buffer size.
+     *        Only the chunk is in memory, whatever the size of the file
+     *
+     * @param file The file
+     * @param out The output
+     */
+    static void copy(File &file, Print &out);
+
+   private:
+    /**
+     * @brief Makes sure the buffer contains the character at the given offset,
+     *        if the file is long enough
+     *
+     * @param offset Distance from the current position
+     * @return bool Wether the character is in the buffer
+     */
+    bool fill(size_t offset);
+
+    /**
+     * @brief Builds the line index of the file in memory
+     */
+    void buildLines();
+
+    /**
+     * @brief Finds the line that starts at the given position in the line index
+     *
+     * @param position The position
+     * @return size_t Index of the line, the amount of lines if there is none
+     */
+    size_t findLine(size_t position);
+};
+
+#endif  // READER_H
@@ -1,30 +1,113 @@
 #include "scanner.h"
 
-#include <AALec-V2.h>
+#include <compiler/compiler.h>
 
 Indentation::Indentation(IndentationType type, int size) :
     type(type),
     size(size) {}
 
-Scanner::Scanner(String inPath) :
+bool ScannerState::equals(const ScannerState &state) const {
+    if (position != state.position || indentationChar != state.indentationChar
+        || indentationSize != state.indentationSize
+        || inBlockInATag != state.inBlockInATag
+        || interpolationLevel != state.interpolationLevel
+        || indentations.size() != state.indentations.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < indentations.size(); i++) {
+        if (indentations[i].type != state.indentations[i].type
+            || indentations[i].size != state.indentations[i].size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Scanner::Scanner(String inPath, GPIOSnapshot &gpios) :
     inPath_(inPath),
-    lastPosition_(0),
     indentationChar_('.'),
-    indentations_(std::vector<Indentation>()),
+    indentations_(ArenaVector<Indentation>()),
+    indentationSize_(0),
     inBlockInATag_(false),
-    interpolationLevel_(0) {}
+    interpolationLevel_(0),
+    reader_(),
+    gpios_(&gpios),
+    compiler_(nullptr),
+    interpolations_(ArenaVector<Interpolation>()),
+    runs_(),
+    runCount_(0),
+    runIndex_(0),
+    token_(TokenType::EndOfPart),
+    hasToken_(false),
+    end_(TokenType::EndOfPart),
+    hasEnd_(false) {}
+
+Scanner::Scanner(String inPath, Compiler &compiler) :
+    inPath_(inPath),
+    indentationChar_('.'),
+    indentations_(ArenaVector<Indentation>()),
+    indentationSize_(0),
+    inBlockInATag_(false),
+    interpolationLevel_(0),
+    reader_(),
+    gpios_(nullptr),
+    compiler_(&compiler),
+    interpolations_(ArenaVector<Interpolation>()),
+    runs_(),
+    runCount_(0),
+    runIndex_(0),
+    token_(TokenType::EndOfPart),
+    hasToken_(false),
+    end_(TokenType::EndOfPart),
+    hasEnd_(false) {}
+
+ScannerState Scanner::state() {
+    ScannerState state = ScannerState();
+    state.position = reader_.position();
+    state.indentationChar = indentationChar_;
+    state.indentations = indentations_;
+    state.indentationSize = indentationSize_;
+    state.inBlockInATag = inBlockInATag_;
+    state.interpolationLevel = interpolationLevel_;
+    return state;
+}
+
+void Scanner::restore(const ScannerState &state) {
+    // If the source can't be opened `scanPart()` reports it
+    if (reader_.isOpen() || reader_.open(inPath_)) {
+        reader_.seek(state.position);
+    }
+
+    indentationChar_ = state.indentationChar;
+    indentations_ = state.indentations;
+    indentationSize_ = state.indentationSize;
+    inBlockInATag_ = state.inBlockInATag;
+    interpolationLevel_ = state.interpolationLevel;
+
+    // Tokens of the previous part are dropped
+    runCount_ = 0;
+    runIndex_ = 0;
+    hasToken_ = false;
+    hasEnd_ = false;
+}
 
-bool Scanner::scanPart(std::vector<Token> &tokens) {
-    inFile_ = LittleFS.open(inPath_, "r");
-    if (!inFile_ || !inFile_.isFile()) {
-        Serial.printf(
-            "Error 1-1: Failed to open file for reading '%s'\n",
+bool Scanner::scanPart() {
+    // Open the source file when scanning the first part
+    if (!reader_.isOpen() && !reader_.open(inPath_)) {
+        log().printf_P(
+            PSTR("Error 1-1: Failed to open file for reading '%s'\n"),
             inPath_.c_str()
         );
-        inFile_.close();
         return false;
     }
-    inFile_.seek(lastPosition_, SeekSet);
+
+    interpolations_.clear();
+    runCount_ = 0;
+    runIndex_ = 0;
+    hasToken_ = false;
+    hasEnd_ = false;
 
     // Ignore empty lines
     while (isEmptyLine()) {
@@ -35,8 +118,7 @@ bool Scanner::scanPart(std::vector<Token> &tokens) {
 
     // Scan the indentation if thers is any
     if (isWhitespace()) {
-        if (!scanIndentation(tokens)) {
-            inFile_.close();
+        if (!scanIndentation()) {
             // Error output from `scanIndentation()`
             return false;
         }
@@ -44,38 +126,38 @@ bool Scanner::scanPart(std::vector<Token> &tokens) {
         // Remove additional indentations from block expansion
         while (indentations_.size() > 0) {
             if (indentations_.back().type == IndentationType::BlockExpansion) {
-                indentations_.pop_back();
-                tokens.push_back(Token(TokenType::Dedent));
+                popIndentation();
+                pushRun(TokenType::Dedent);
             } else {
                 break;
             }
         }
     } else if (check(':')) {
         // Block expansion, add a Indent Token and a 0 size indent level
-        tokens.push_back(Token(TokenType::Indent));
-        indentations_.push_back(Indentation(IndentationType::BlockExpansion));
+        pushRun(TokenType::Indent);
+        pushIndentation(Indentation(IndentationType::BlockExpansion));
 
         // Ignore the colon and following whitespace
         ignore();
         ignoreWhitespaces();
-    } else if (check("#[")) {
+    } else if (check(PSTR("#["))) {
         interpolationLevel_++;
-        indentations_.push_back(Indentation(IndentationType::TagInterpolation));
-        tokens.push_back(Token(TokenType::Indent));
+        pushIndentation(Indentation(IndentationType::TagInterpolation));
+        pushRun(TokenType::Indent);
         ignore(2);
     } else if (check(']')) {
         interpolationLevel_--;
         if (interpolationLevel_ > 0) {
-            indentations_.pop_back();
-            tokens.push_back(Token(TokenType::Dedent));
+            popIndentation();
+            pushRun(TokenType::Dedent);
         }
     } else if (indentations_.size() > 0) {
         // If there is an indentation level, but no indentation, its a dedent
         while (indentations_.size() > 0) {
             if (indentations_.back().type != IndentationType::Conditional) {
-                tokens.push_back(Token(TokenType::Dedent));
+                pushRun(TokenType::Dedent);
             }
-            indentations_.pop_back();
+            popIndentation();
         }
 
         // Remove additional indentations from block expansion and conditionals
@@ -83,10 +165,10 @@ bool Scanner::scanPart(std::vector<Token> &tokens) {
             Indentation back = indentations_.back();
 
             if (back.type == IndentationType::BlockExpansion) {
-                indentations_.pop_back();
-                tokens.push_back(Token(TokenType::Dedent));
+                popIndentation();
+                pushRun(TokenType::Dedent);
             } else if (back.type == IndentationType::Conditional) {
-                indentations_.pop_back();
+                popIndentation();
             } else {
                 break;
             }
@@ -94,125 +176,187 @@ bool Scanner::scanPart(std::vector<Token> &tokens) {
     }
 
     // Scan a token if there is a token
-    if (check("doctype")) {
+    Keyword keyword = checkKeyword();
+    if (keyword == Keyword::Doctype) {
         DoctypeData data = DoctypeData();
         if (!scanDoctype(data)) {
-            inFile_.close();
             // Error output from `scanDoctype()`
             return false;
         }
-        tokens.push_back(Token(data));
-    } else if (check("<") || check('|') || check(']')) {
+        token_ = Token(std::move(data));
+        hasToken_ = true;
+    } else if (keyword == Keyword::Text) {
         TextData data = TextData();
         if (!scanText(data)) {
-            inFile_.close();
             // Error output from `scanText()`
             return false;
         }
-        tokens.push_back(Token(data));
-    } else if (check("//-")) {
+        token_ = Token(std::move(data));
+        hasToken_ = true;
+    } else if (keyword == Keyword::IgnoredComment) {
         if (!ignoreComment()) {
-            inFile_.close();
             // Error output from `ignoreComment()`
             return false;
         }
-    } else if (check("//")) {
+    } else if (keyword == Keyword::Comment) {
         CommentData data = CommentData();
         if (!scanComment(data)) {
-            inFile_.close();
             // Error output from `scanComment()`
             return false;
         }
-        tokens.push_back(Token(data));
-    } else if (check("include")) {
+        token_ = Token(std::move(data));
+        hasToken_ = true;
+    } else if (keyword == Keyword::Include) {
         IncludeData data = IncludeData();
         if (!scanInclude(data)) {
-            inFile_.close();
             // Error output from `scanInclude()`
             return false;
         }
-        tokens.push_back(Token(data));
-    } else if (check("if") || check("unless") || check("else")) {
+        token_ = Token(std::move(data));
+        hasToken_ = true;
+    } else if (keyword == Keyword::Conditional) {
         if (!scanConditional()) {
-            inFile_.close();
             // Error output from `scanConditional()`
             return false;
         }
-    } else if (isIdentifierPart() || (check('#') && !check("#["))
+    } else if (isIdentifierPart() || (check('#') && !check(PSTR("#[")))
                || check('.')) {
         TagData data = TagData();
         if (!scanTag(data)) {
-            inFile_.close();
             // Error output from `scanTag()`
             return false;
         }
-        tokens.push_back(Token(data));
+        token_ = Token(std::move(data));
+        hasToken_ = true;
     }
 
     // Handle the part after the token
     if (isEndOfSource()) {
-        tokens.push_back(Token(TokenType::EndOfSource));
+        end_ = TokenType::EndOfSource;
     } else if (check('\n')) {
         ignore();
-        tokens.push_back(Token(TokenType::EndOfPart));
-    } else if (check(':') || check("#[") || check(']')) {
-        tokens.push_back(Token(TokenType::EndOfPart));
+        end_ = TokenType::EndOfPart;
+    } else if (check(':') || check(PSTR("#[")) || check(']')) {
+        end_ = TokenType::EndOfPart;
     } else {
-        inFile_.close();
-        printErrorUnexpectedChar("Error 1-2");
+        printErrorUnexpectedChar(2);
+        return false;
+    }
+    hasEnd_ = true;
+
+    // The runs didn't fit into the part
+    if (runCount_ > AALEC_PUG_TOKEN_RUNS) {
+        log().printf_P(
+            PSTR("Error 1-18: Too many indentation changes at %s:%d\n"),
+            inPath_.c_str(),
+            (int)reader_.position()
+        );
         return false;
     }
 
-    lastPosition_ = inFile_.position();
-    inFile_.close();
     return true;
 }
 
-void Scanner::printErrorUnexpectedChar(String name) {
-    Serial.printf(
-        "%s: Unexpected character (ASCII code: '%d') at %s:%d\n",
-        name.c_str(),
-        inFile_.peek(),
-        inPath_.c_str(),
-        inFile_.position()
-    );
+Token Scanner::nextToken() {
+    if (runIndex_ < runCount_) {
+        TokenRun &run = runs_[runIndex_];
+        if (--run.count == 0) {
+            runIndex_++;
+        }
+        return Token(run.type);
+    }
+
+    if (hasToken_) {
+        hasToken_ = false;
+        return std::move(token_);
+    }
+
+    if (hasEnd_) {
+        hasEnd_ = false;
+        return Token(end_);
+    }
+
+    return Token(TokenType::EndOfPart);
 }
 
-bool Scanner::check(char value) {
-    return inFile_.peek() == value;
+bool Scanner::hasTokens() {
+    return runIndex_ < runCount_ || hasToken_ || hasEnd_;
 }
 
-bool Scanner::check(String value) {
-    // Remember the start position
-    int start = inFile_.position();
-    bool res = true;
-
-    // Check each character
-    for (char c : value) {
-        if (inFile_.read() != c) {
-            // Set the return value, end the loop
-            res = false;
-            break;
-        }
+void Scanner::pushRun(TokenType type) {
+    // Extend the last run
+    if (runCount_ > 0 && runCount_ <= AALEC_PUG_TOKEN_RUNS
+        && runs_[runCount_ - 1].type == type) {
+        runs_[runCount_ - 1].count++;
+        return;
     }
 
-    // Reset the stream position
-    inFile_.seek(start, SeekSet);
-    return res;
+    // Start a new run, `scanPart()` reports runs that don't fit
+    if (runCount_ < AALEC_PUG_TOKEN_RUNS) {
+        runs_[runCount_] = TokenRun(type, 1);
+    }
+    runCount_++;
 }
 
-String Scanner::consume(int amount) {
-    String value = "";
+Print &Scanner::log() {
+    if (compiler_ != nullptr) {
+        return compiler_->log();
+    }
 
-    for (int i = 0; i < amount; i++) {
-        value += (char)inFile_.read();
+    return Serial;
+}
+
+bool Scanner::decide(const Expression &expression) {
+    // GPIO values while rendering directly are evaluated right away
+    if (compiler_ == nullptr) {
+        return expression.evaluate(*gpios_);
     }
 
-    return value;
+    // Constant expressions don't read any GPIO
+    if (expression.isConstant()) {
+        GPIOSnapshot none = GPIOSnapshot();
+        return expression.evaluate(none);
+    }
+
+    // Otherwise the compiler decides which path it compiles
+    return compiler_->decide(expression);
+}
+
+void Scanner::printErrorUnexpectedChar(int code) {
+    log().printf_P(
+        PSTR("Error 1-%d: Unexpected character (ASCII code: '%d') at %s:%d\n"),
+        code,
+        reader_.peek(),
+        inPath_.c_str(),
+        (int)reader_.position()
+    );
+}
+
+bool Scanner::check(char value) {
+    return reader_.peek() == value;
+}
+
+bool Scanner::check(const char *value) {
+    return reader_.startsWith(value);
+}
+
+void Scanner::consume(SourceString &value, int amount) {
+    if (reader_.isInMemory()) {
+        // View into the source, only copies if the characters don't follow the
+        // ones already in the value
+        size_t length = (size_t)amount < reader_.buffered() ? amount
+                                                            : reader_.buffered();
+        value.extend(reader_.current(), length);
+        reader_.skip(length);
+    } else {
+        for (int i = 0; i < amount; i++) {
+            value.append((char)reader_.read());
+        }
+    }
 }
 
 void Scanner::ignore(int amount) {
-    inFile_.seek(amount, SeekCur);
+    reader_.skip(amount);
 }
 
 void Scanner::ignoreWhitespaces(bool includeNewlines) {
@@ -221,52 +365,53 @@ void Scanner::ignoreWhitespaces(bool includeNewlines) {
     }
 }
 
+void Scanner::ignoreLine() {
+    reader_.skipLine();
+}
+
+void Scanner::ignoreIndentedLines() {
+    // Also sets the indentation char if it isn't set yet
+    if (!nextLineIndentationIsHigher()) {
+        return;
+    }
+
+    reader_.skipIndentedLines(indentationChar_, indentationSize_);
+}
+
 bool Scanner::isWhitespace() {
     return check(' ') || check('\t');
 }
 
 bool Scanner::isDigit() {
-    return isdigit(inFile_.peek());
+    return isdigit(reader_.peek());
 }
 
 bool Scanner::isIdentifierPart() {
-    return isAlphaNumeric(inFile_.peek()) || check('_');
+    return isAlphaNumeric(reader_.peek()) || check('_');
 }
 
 bool Scanner::isEmptyLine() {
-    int startPostion = inFile_.position();
-    bool res = false;
-
-    while (isWhitespace()) {
-        ignore();
-    }
-
-    if (check('\n')) {
-        res = true;
+    // Look ahead over the whitespaces without removing them
+    size_t offset = 0;
+    while (reader_.peek(offset) == ' ' || reader_.peek(offset) == '\t') {
+        offset++;
     }
 
-    inFile_.seek(startPostion, SeekSet);
-    return res;
+    return reader_.peek(offset) == '\n';
 }
 
 bool Scanner::isEndOfSource() {
-    return inFile_.peek() == -1;
+    return reader_.peek() == -1;
 }
 
 bool Scanner::nextLineIndentationIsHigher() {
-    // Get total size of current indentation
-    int currentSize = 0;
-    for (Indentation obj : indentations_) {
-        currentSize += obj.size;
-    }
-
     // Set the indentation char if not alread set
     if (indentationChar_ == '.') {
         // Not set...
-        if (check("\n ")) {
+        if (check(PSTR("\n "))) {
             // ... and next line is indentet with a space
             indentationChar_ = ' ';
-        } else if (check("\n\t")) {
+        } else if (check(PSTR("\n\t"))) {
             // ... and next line is indentet with a tab
             indentationChar_ = '\t';
         } else {
@@ -275,111 +420,186 @@ bool Scanner::nextLineIndentationIsHigher() {
         }
     }
 
-    // Generate string with '\n' + indentation size * indentation char + extra indentation char
-    String higherIndentation = "\n";
+    // '\n' followed by more indentation chars than the current indentation size
+    return check('\n') && countIndentation(1) > indentationSize_;
+}
 
-    for (int i = 0; i < currentSize; i++) {
-        higherIndentation += indentationChar_;
+bool Scanner::nextLineIsPartOfSameConditional() {
+    // '\n' followed by exactly the current indentation size and "else"
+    return check('\n') && countIndentation(1) == indentationSize_
+        && reader_.startsWith(PSTR("else"), indentationSize_ + 1);
+}
+
+int Scanner::countIndentation(size_t offset) {
+    int size = 0;
+    while (reader_.peek(offset + size) == indentationChar_) {
+        size++;
     }
 
-    higherIndentation += indentationChar_;
+    return size;
+}
 
-    return check(higherIndentation);
+void Scanner::pushIndentation(Indentation indentation) {
+    indentations_.push_back(indentation);
+    indentationSize_ += indentation.size;
 }
 
-bool Scanner::nextLineIsPartOfSameConditional() {
-    // Get total size of current indentation
-    int currentSize = 0;
-    for (Indentation obj : indentations_) {
-        currentSize += obj.size;
+void Scanner::popIndentation() {
+    indentationSize_ -= indentations_.back().size;
+    indentations_.pop_back();
+}
+
+Keyword Scanner::checkKeyword() {
+    // Decide on the first character, then compare the rest of the keyword
+    switch (reader_.peek()) {
+        case 'd':
+            return check(PSTR("doctype")) ? Keyword::Doctype : Keyword::None;
+        case '<':
+        case '|':
+        case ']':
+            return Keyword::Text;
+        case '/':
+            if (reader_.peek(1) != '/') {
+                return Keyword::None;
+            }
+            return reader_.peek(2) == '-' ? Keyword::IgnoredComment
+                                          : Keyword::Comment;
+        case 'i':
+            if (reader_.peek(1) == 'f') {
+                return Keyword::Conditional;
+            }
+            return check(PSTR("include")) ? Keyword::Include : Keyword::None;
+        case 'u':
+        case 'e':
+            return checkConditionalKeyword() != ConditionalKeyword::None
+                ? Keyword::Conditional
+                : Keyword::None;
+        default:
+            return Keyword::None;
     }
+}
 
-    // Generate string with '\n' + indentation size * indentation char + "else"
-    String comparisonString = "\n";
+ConditionalKeyword Scanner::checkConditionalKeyword() {
+    switch (reader_.peek()) {
+        case 'i':
+            return check(PSTR("if")) ? ConditionalKeyword::If
+                                     : ConditionalKeyword::None;
+        case 'u':
+            return check(PSTR("unless")) ? ConditionalKeyword::Unless
+                                         : ConditionalKeyword::None;
+        case 'e':
+            if (!check(PSTR("else"))) {
+                return ConditionalKeyword::None;
+            }
 
-    for (int i = 0; i < currentSize; i++) {
-        comparisonString += indentationChar_;
+            // "else if" or "else unless" with exactly one space
+            if (reader_.peek(4) == ' ') {
+                if (reader_.startsWith(PSTR("if"), 5)) {
+                    return ConditionalKeyword::ElseIf;
+                } else if (reader_.startsWith(PSTR("unless"), 5)) {
+                    return ConditionalKeyword::ElseUnless;
+                }
+            }
+
+            return ConditionalKeyword::Else;
+        default:
+            return ConditionalKeyword::None;
     }
+}
 
-    comparisonString += "else";
+GPIOId Scanner::checkGPIOId() {
+    if (!check(PSTR("IO_"))) {
+        return GPIOId::None;
+    }
 
-    return check(comparisonString);
+    // Decide on the first character after "IO_", then compare the rest
+    switch (reader_.peek(3)) {
+        case 'L':
+            return reader_.startsWith(PSTR("LED"), 3) ? GPIOId::LED
+                                                      : GPIOId::None;
+        case 'B':
+            return reader_.startsWith(PSTR("BUTTON"), 3) ? GPIOId::Button
+                                                         : GPIOId::None;
+        case 'R':
+            return reader_.startsWith(PSTR("ROTATE"), 3) ? GPIOId::Rotate
+                                                         : GPIOId::None;
+        case 'T':
+            if (!reader_.startsWith(PSTR("TEMP"), 3)) {
+                return GPIOId::None;
+            }
+            return reader_.startsWith(PSTR("_AGE"), 7) ? GPIOId::TempAge
+                                                       : GPIOId::Temp;
+        case 'H':
+            if (!reader_.startsWith(PSTR("HUMIDITY"), 3)) {
+                return GPIOId::None;
+            }
+            return reader_.startsWith(PSTR("_AGE"), 11) ? GPIOId::HumidityAge
+                                                        : GPIOId::Humidity;
+        case 'A':
+            return reader_.startsWith(PSTR("ANALOG"), 3) ? GPIOId::Analog
+                                                         : GPIOId::None;
+        default:
+            return GPIOId::None;
+    }
 }
 
-bool Scanner::scanIndentation(std::vector<Token> &tokens) {
+bool Scanner::scanIndentation() {
     // Set the used indentation char if not already set
     if (indentationChar_ == '.') {
-        indentationChar_ = inFile_.peek();
+        indentationChar_ = reader_.peek();
     }
 
-    // Check on what level we are
-    uint level;
-    for (level = 0; level < indentations_.size(); level++) {
-        int levelSize = indentations_[level].size;
+    // Count the indentation chars of this line
+    int size = countIndentation(0);
 
-        // Create string
-        String indentationString = "";
-        for (int i = 0; i < levelSize; i++) {
-            indentationString += indentationChar_;
-        }
+    if (size > indentationSize_) {
+        // More indentation chars than the current levels -> add a new level
+        int newLevelSize = size - indentationSize_;
 
-        if (check(indentationString)) {
-            ignore(levelSize);
+        // Are we in a new conditional?
+        if (!indentations_.empty()
+            && indentations_.back().type == IndentationType::Conditional
+            && indentations_.back().size == 0) {
+            indentations_.back().size = newLevelSize;
+            indentationSize_ += newLevelSize;
         } else {
-            break;
+            pushIndentation(
+                Indentation(IndentationType::Default, newLevelSize)
+            );
+            pushRun(TokenType::Indent);
         }
-    }
-
-    // If there are no more indentation chars
-    if (!check(indentationChar_)) {
+    } else {
         // We are either on the same level -> nothing must be done
         // or a smaller level -> generate dedents and remove the levels
-        while (level < indentations_.size()) {
+        while (indentationSize_ > size) {
             if (indentations_.back().type != IndentationType::Conditional) {
-                tokens.push_back(Token(TokenType::Dedent));
+                pushRun(TokenType::Dedent);
             }
-            indentations_.pop_back();
+            popIndentation();
         }
-    } else {
-        // If there are more indentation chars
-        // We are either on a new level -> add a new level
-        // or the indentation chars are not enough to reach the next level -> error
-        if (level == indentations_.size()) {
-            int newLevelSize = 0;
-
-            while (check(indentationChar_)) {
-                newLevelSize++;
-                ignore();
-            }
 
-            // Are we in a new conditional?
-            Indentation back = indentations_.back();
-            if (back.type == IndentationType::Conditional && back.size == 0) {
-                indentations_.back().size = newLevelSize;
-            } else {
-                indentations_.push_back(
-                    Indentation(IndentationType::Default, newLevelSize)
-                );
-                tokens.push_back(Token(TokenType::Indent));
-            }
-        } else {
-            Serial.printf(
-                "Error 1-3: Wrong indentation amount at %s:%d\n",
+        // The indentation chars are not enough to reach the next level -> error
+        if (indentationSize_ < size) {
+            ignore(indentationSize_);
+            log().printf_P(
+                PSTR("Error 1-3: Wrong indentation amount at %s:%d\n"),
                 inPath_.c_str(),
-                inFile_.position()
+                (int)reader_.position()
             );
             return false;
         }
     }
 
+    ignore(size);
+
     // If there are still spaces or tabs left
     // That means the wrong character was used for indentation
     if (check(' ') || check('\t')) {
-        Serial.printf(
-            "Error 1-4: Wrong indentation character (ASCII code: '%d') at %s:%d\n",
-            inFile_.peek(),
+        log().printf_P(
+            PSTR("Error 1-4: Wrong indentation character (ASCII code: '%d') at %s:%d\n"),
+            reader_.peek(),
             inPath_.c_str(),
-            inFile_.position()
+            (int)reader_.position()
         );
         return false;
     }
@@ -393,30 +613,30 @@ bool Scanner::scanDoctype(DoctypeData &data) {
     ignoreWhitespaces();
 
     // Get the doctype value
-    String value = "";
+    SourceString value = SourceString();
     while (!check('\n')) {
-        value += consume();
+        consume(value);
     }
 
     // Create the data
-    data = DoctypeData(value);
+    data = DoctypeData(std::move(value));
 
     return true;
 }
 
 bool Scanner::scanTag(TagData &data) {
     // Data required for the tag
-    String name = "";
-    String idLiteral = "";
-    String classLiteral = "";
-    std::vector<Attribute> attributes = std::vector<Attribute>();
+    SourceString name = SourceString();
+    SourceString idLiteral = SourceString();
+    SourceString classLiteral = SourceString();
+    ArenaVector<Attribute> attributes = ArenaVector<Attribute>();
     bool forcedVoidElement = false;
-    String text = "";
+    SourceString text = SourceString();
 
     // Get the tag name
     if (isIdentifierPart()) {
         while (isIdentifierPart()) {
-            name += consume();
+            consume(name);
         }
     } else if (check('#') || check('.')) {
         name = "div";
@@ -427,26 +647,26 @@ bool Scanner::scanTag(TagData &data) {
         ignore();
 
         while (isIdentifierPart()) {
-            idLiteral += consume();
+            consume(idLiteral);
         }
     }
 
     // Class Literal
-    if (check('.') && !check(".\n")) {
+    if (check('.') && !check(PSTR(".\n"))) {
         ignore();
 
         while (isIdentifierPart()) {
-            classLiteral += consume();
+            consume(classLiteral);
         }
     }
 
     // Add the class literal if it exists (should be first attribute)
-    if (classLiteral != "") {
+    if (!classLiteral.isEmpty()) {
         attributes.push_back(Attribute("class", classLiteral));
     }
 
     // Add the id literal if it exists (should be after the class literal)
-    if (idLiteral != "") {
+    if (!idLiteral.isEmpty()) {
         attributes.push_back(Attribute("id", idLiteral));
     }
 
@@ -463,26 +683,32 @@ bool Scanner::scanTag(TagData &data) {
     if (check('/')) {
         ignore();
         forcedVoidElement = true;
-    } else if (check(' ') || check(".\n")) {
+    } else if (check(' ') || check(PSTR(".\n"))) {
         if (!scanTagText(text)) {
             // Error output from `scanTagText()`
             return false;
         }
     } else if (!check(':') && !check('\n')) {
-        printErrorUnexpectedChar("Error 1-5");
+        printErrorUnexpectedChar(5);
         return false;
     }
 
-    data = TagData(name, attributes, forcedVoidElement, text);
+    data = TagData(
+        std::move(name),
+        std::move(attributes),
+        forcedVoidElement,
+        std::move(text),
+        std::move(interpolations_)
+    );
     return true;
 }
 
-bool Scanner::scanTagAttributes(std::vector<Attribute> &attributes) {
+bool Scanner::scanTagAttributes(ArenaVector<Attribute> &attributes) {
     // Ignore the leading '('
     if (check('(')) {
         ignore();
     } else {
-        printErrorUnexpectedChar("Error 1-6");
+        printErrorUnexpectedChar(6);
         return false;
     }
 
@@ -498,36 +724,42 @@ bool Scanner::scanTagAttributes(std::vector<Attribute> &attributes) {
         ignoreWhitespaces(true);
 
         // Get the key (possibly quoted)
-        String key = "";
+        SourceString key = SourceString();
         if (check('"') || check('\'')) {
             // Get the quote
-            char quote = consume()[0];
+            char quote = reader_.read();
 
             // Consume until the quote
             while (!check(quote)) {
-                key += consume();
+                consume(key);
             }
 
             // Ignore the closing quote
             ignore();
         } else {
             while (isIdentifierPart()) {
-                key += consume();
+                consume(key);
             }
         }
 
+        // Nothing could be consumed, eg: a '-' in the key
+        if (key.isEmpty()) {
+            printErrorUnexpectedChar(19);
+            return false;
+        }
+
         // Ignore whitespaces after the key
         ignoreWhitespaces(true);
 
         // Unescaped?
         bool escaped = true;
-        if (check("!")) {
+        if (check('!')) {
             ignore();
             escaped = false;
         }
 
         // Ignore the "=" if there is one
-        String value = "";
+        SourceString value = SourceString();
         bool booleanAttribute = false;
         bool checked = false;
         if (check('=')) {
@@ -539,39 +771,41 @@ bool Scanner::scanTagAttributes(std::vector<Attribute> &attributes) {
             // Get the value
             if (check('"') || check('\'')) {
                 // Get the quote
-                char quote = consume()[0];
+                char quote = reader_.read();
 
                 // Consume until the quote
                 while (!check(quote)) {
-                    String c = consume();
-
-                    // Replace bad chars if escaped
-                    if (escaped) {
-                        if (c == "\"") {
-                            c = "&quot;";
-                        } else if (c == "<") {
-                            c = "&lt;";
-                        } else if (c == ">") {
-                            c = "&gt;";
-                        } else if (c == "&") {
-                            c = "&amp;";
-                        }
+                    // Replace bad chars if escaped, this makes a copy of the value
+                    if (escaped && check('"')) {
+                        ignore();
+                        value.append("&quot;");
+                    } else if (escaped && check('<')) {
+                        ignore();
+                        value.append("&lt;");
+                    } else if (escaped && check('>')) {
+                        ignore();
+                        value.append("&gt;");
+                    } else if (escaped && check('&')) {
+                        ignore();
+                        value.append("&amp;");
+                    } else {
+                        consume(value);
                     }
-
-                    value += c;
                 }
 
                 // Ignore the closing quote
                 ignore();
-            } else if (check('(') || check("True") || check("False")
-                       || check("IO_") || isDigit()) {
-                if (!scanExpression(checked)) {
+            } else if (check('(') || check(PSTR("True")) || check(PSTR("False"))
+                       || check(PSTR("IO_")) || isDigit()) {
+                Expression expression = Expression();
+                if (!scanExpression(expression)) {
                     // Error output from `scanExpression()`
                     return false;
                 }
+                checked = decide(expression);
                 booleanAttribute = true;
             } else {
-                printErrorUnexpectedChar("Error 1-7");
+                printErrorUnexpectedChar(7);
                 return false;
             }
         } else {
@@ -601,7 +835,7 @@ bool Scanner::scanTagAttributes(std::vector<Attribute> &attributes) {
     return true;
 }
 
-bool Scanner::scanTagText(String &value) {
+bool Scanner::scanTagText(SourceString &value) {
     // Inline in a tag or block in a tag?
     if (check(' ')) {
         // Ignore the leading space
@@ -611,7 +845,7 @@ bool Scanner::scanTagText(String &value) {
             // Error output from `scanTagTextInline()`
             return false;
         }
-    } else if (check(".\n")) {
+    } else if (check(PSTR(".\n"))) {
         // Ignore the leading '.'
         ignore();
 
@@ -624,11 +858,11 @@ bool Scanner::scanTagText(String &value) {
     return true;
 }
 
-bool Scanner::scanTagTextInline(String &value) {
+bool Scanner::scanTagTextInline(SourceString &value) {
     // Depending on if we are in a interpolation
     if (interpolationLevel_ > 0) {
         // Consume until the end of the interpolation or the start of a new interpolation
-        while (!check(']') && !check("#[")) {
+        while (!check(']') && !check(PSTR("#["))) {
             if (!scanTagTextPart(value)) {
                 // Error output from `scanTagTextPart()`
                 return false;
@@ -636,7 +870,7 @@ bool Scanner::scanTagTextInline(String &value) {
         }
     } else {
         // Consume until the '\n' or a tag interpolation start
-        while (!check('\n') && !check("#[")) {
+        while (!check('\n') && !check(PSTR("#["))) {
             if (!scanTagTextPart(value)) {
                 // Error output from `scanTagTextPart()`
                 return false;
@@ -647,9 +881,9 @@ bool Scanner::scanTagTextInline(String &value) {
     return true;
 }
 
-bool Scanner::scanTagTextBlock(String &value) {
+bool Scanner::scanTagTextBlock(SourceString &value) {
     // Consume until the end of the first line
-    while (!check('\n') && !check("#[")) {
+    while (!check('\n') && !check(PSTR("#["))) {
         if (!scanTagTextPart(value)) {
             // Error output from `scanTagTextPart()`
             return false;
@@ -659,7 +893,7 @@ bool Scanner::scanTagTextBlock(String &value) {
     // While indentation is higher, consume lines
     while (nextLineIndentationIsHigher()) {
         // Consume the '\n' of the current line, ignore the first (except when we are already in a block in a tag)
-        if (value != "" || inBlockInATag_) {
+        if (!value.isEmpty() || inBlockInATag_) {
             if (!scanTagTextPart(value)) {
                 // Error output from `scanTagTextPart()`
                 return false;
@@ -672,7 +906,7 @@ bool Scanner::scanTagTextBlock(String &value) {
         ignoreWhitespaces();
 
         // Consume the next line up until the '\n' or a tag interpolation start
-        while (!check('\n') && !check("#[")) {
+        while (!check('\n') && !check(PSTR("#["))) {
             if (!scanTagTextPart(value)) {
                 // Error output from `scanTagTextPart()`
                 return false;
@@ -690,29 +924,29 @@ bool Scanner::scanTagTextBlock(String &value) {
     return true;
 }
 
-bool Scanner::scanTagTextPart(String &value) {
-    if (check("#{IO_")) {
+bool Scanner::scanTagTextPart(SourceString &value) {
+    if (check(PSTR("#{IO_"))) {
         // Ignore the "#{"
         ignore(2);
 
-        // Get the GPIO value
-        uint gpio = 0;
-
-        if (!scanGPIOValue(gpio)) {
-            // Error output from `scanGPIOValue()`
+        // Get the GPIO
+        GPIOId id = GPIOId::None;
+        if (!scanGPIOId(id)) {
+            // Error output from `scanGPIOId()`
             return false;
         }
 
-        value += String(gpio);
+        // The value is inserted when the text is written
+        interpolations_.push_back(Interpolation(value.length(), id));
 
-        if (!check("}")) {
-            printErrorUnexpectedChar("Error 1-8");
+        if (!check('}')) {
+            printErrorUnexpectedChar(8);
             return false;
         } else {
             ignore();
         }
     } else {
-        value += consume();
+        consume(value);
     }
 
     return true;
@@ -730,20 +964,20 @@ bool Scanner::scanText(TextData &data) {
         // Error output from `scanTextInterpolationEnd()`
         return scanTextInterpolationEnd(data);
     } else {
-        printErrorUnexpectedChar("Error 1-9");
+        printErrorUnexpectedChar(9);
         return false;
     }
 }
 
 bool Scanner::scanTextLiteralHTML(TextData &data) {
-    String value = "";
+    SourceString value = SourceString();
 
     // Consume until the '\n'
     while (!check('\n')) {
-        value += consume();
+        consume(value);
     }
 
-    data = TextData(value, TextType::LiteralHTML);
+    data = TextData(std::move(value), TextType::LiteralHTML);
     return true;
 }
 
@@ -752,19 +986,23 @@ bool Scanner::scanTextPipedText(TextData &data) {
     ignore();
     ignoreWhitespaces();
 
-    String value = "";
+    SourceString value = SourceString();
 
     if (!scanTagTextInline(value)) {
         // Error output from `scanTagTextInline()`
         return false;
     }
 
-    data = TextData(value, TextType::PipedText);
+    data = TextData(
+        std::move(value),
+        TextType::PipedText,
+        std::move(interpolations_)
+    );
     return true;
 }
 
 bool Scanner::scanTextInterpolationEnd(TextData &data) {
-    String value = "";
+    SourceString value = SourceString();
 
     // Ignore the leading ']'
     ignore();
@@ -782,26 +1020,20 @@ bool Scanner::scanTextInterpolationEnd(TextData &data) {
         }
     }
 
-    data = TextData(value, TextType::InnerText);
+    data = TextData(
+        std::move(value),
+        TextType::InnerText,
+        std::move(interpolations_)
+    );
     return true;
 }
 
 bool Scanner::ignoreComment() {
     // Ignore this line up until the '\n'
-    while (!check('\n')) {
-        ignore();
-    }
-
-    // While indentation is higher, ignore lines
-    while (nextLineIndentationIsHigher()) {
-        // Ignore the '\n' of the current line
-        ignore();
+    ignoreLine();
 
-        // Ignore the next line up until the '\n'
-        while (!check('\n')) {
-            ignore();
-        }
-    }
+    // Ignore all lines with a higher indentation
+    ignoreIndentedLines();
 
     return true;
 }
@@ -811,11 +1043,11 @@ bool Scanner::scanComment(CommentData &data) {
     ignore(2);
 
     // Text of the comment
-    String value = "";
+    SourceString value = SourceString();
 
     // Consume this line up until the '\n'
     while (!check('\n')) {
-        value += consume();
+        consume(value);
     }
 
     // Ignore the '\n' of the first line (only to mimic PUG closer)
@@ -825,7 +1057,7 @@ bool Scanner::scanComment(CommentData &data) {
     while (nextLineIndentationIsHigher()) {
         // Consume the '\n' of the current line, ignore it if it is the first line
         if (!firstLine) {
-            value += consume();
+            consume(value);
         } else {
             ignore();
             firstLine = false;
@@ -836,11 +1068,11 @@ bool Scanner::scanComment(CommentData &data) {
 
         // Consume the next line up until the '\n'
         while (!check('\n')) {
-            value += consume();
+            consume(value);
         }
     }
 
-    data = CommentData(value);
+    data = CommentData(std::move(value));
     return true;
 }
 
@@ -852,92 +1084,76 @@ bool Scanner::scanInclude(IncludeData &data) {
     ignoreWhitespaces();
 
     // Get the path
-    String path = "";
+    SourceString path = SourceString();
 
     while (!check('\n')) {
-        path += consume();
+        consume(path);
     }
 
-    data = IncludeData(path);
+    data = IncludeData(std::move(path));
     return true;
 }
 
-bool Scanner::scanGPIOValue(uint &result) {
-    if (check("IO_LED")) {
-        ignore(6);
-        result = aalec.get_led();
-        return true;
-    } else if (check("IO_BUTTON")) {
-        ignore(9);
-        result = aalec.get_button();
-        return true;
-    } else if (check("IO_ROTATE")) {
-        ignore(9);
-        result = aalec.get_rotate();
-        return true;
-    } else if (check("IO_TEMP")) {
-        ignore(7);
-        result = aalec.get_temp();
-        return true;
-    } else if (check("IO_HUMIDITY")) {
-        ignore(11);
-        result = aalec.get_humidity();
-        return true;
-    } else if (check("IO_ANALOG")) {
-        ignore(9);
-        result = aalec.get_analog();
-        return true;
-    } else {
-        printErrorUnexpectedChar("Error 1-10");
-        return false;
+bool Scanner::scanGPIOId(GPIOId &id) {
+    id = checkGPIOId();
+
+    switch (id) {
+        case GPIOId::LED:
+            ignore(6);
+            return true;
+        case GPIOId::Button:
+        case GPIOId::Rotate:
+        case GPIOId::Analog:
+            ignore(9);
+            return true;
+        case GPIOId::Temp:
+            ignore(7);
+            return true;
+        case GPIOId::Humidity:
+        case GPIOId::TempAge:
+            ignore(11);
+            return true;
+        case GPIOId::HumidityAge:
+            ignore(15);
+            return true;
+        default:
+            printErrorUnexpectedChar(10);
+            return false;
     }
 }
 
-bool Scanner::scanExpression(bool &result) {
+bool Scanner::scanExpression(Expression &expression) {
     if (check('(')) {
         // Ignore the '(' and following whitespace
         ignore();
         ignoreWhitespaces();
 
-        u32 firstExprResult = 0;
-        bool firstIsTrue = false;
-        u32 secondExprResult = 0;
-        bool secondIsTrue = false;
+        expression.type = ExpressionType::Equals;
 
-        if (!scanExpressionEvaluate(firstExprResult, firstIsTrue)) {
-            // Error output from `scanExpressionEvaluate()`
+        if (!scanOperand(expression.left)) {
+            // Error output from `scanOperand()`
             return false;
         }
 
         // Ignore the '=' and surounding whitespace
         ignoreWhitespaces();
         if (!check('=')) {
-            printErrorUnexpectedChar("Error 1-11");
+            printErrorUnexpectedChar(11);
             return false;
         } else {
             ignore();
         }
         ignoreWhitespaces();
 
-        if (!scanExpressionEvaluate(secondExprResult, secondIsTrue)) {
-            // Error output from `scanExpressionEvaluate()`
+        if (!scanOperand(expression.right)) {
+            // Error output from `scanOperand()`
             return false;
         }
 
-        if (firstIsTrue && secondIsTrue) {
-            result = true;
-        } else if (firstIsTrue) {
-            result = secondExprResult != 0;
-        } else if (secondIsTrue) {
-            result = firstExprResult != 0;
-        } else {
-            result = firstExprResult == secondExprResult;
-        }
-
         // Ignore the closing ')', and whitespace before it
         ignoreWhitespaces();
         if (!check(')')) {
-            printErrorUnexpectedChar("Error 1-12");
+            printErrorUnexpectedChar(12);
             return false;
         } else {
             ignore();
@@ -945,97 +1161,86 @@ bool Scanner::scanExpression(bool &result) {
 
         return true;
     } else {
-        u32 exprResult = 0;
-        bool isTrue = false;
+        expression.type = ExpressionType::Value;
 
-        if (!scanExpressionEvaluate(exprResult, isTrue)) {
-            // Error output from `scanExpressionEvaluate()`
-            return false;
-        }
-
-        result = isTrue || exprResult != 0;
-
-        return true;
+        // Error output from `scanOperand()`
+        return scanOperand(expression.left);
     }
 }
 
-bool Scanner::scanExpressionEvaluate(u32 &result, bool &isTrue) {
-    if (check("True")) {
+bool Scanner::scanOperand(Operand &operand) {
+    if (check(PSTR("True"))) {
         ignore(4);
-        result = 1;
-        isTrue = true;
+        operand = Operand(OperandType::True);
         return true;
-    } else if (check("False")) {
+    } else if (check(PSTR("False"))) {
         ignore(5);
-        result = 0;
-        isTrue = false;
+        operand = Operand(OperandType::False);
         return true;
     } else if (isDigit()) {
-        String value = "";
+        SourceString value = SourceString();
         while (isDigit()) {
-            value += consume();
+            consume(value);
         }
-        result = value.toInt();
-        isTrue = false;
+        operand = Operand(OperandType::Number, value.toString().toInt());
         return true;
-    } else if (check("IO_")) {
-        if (!scanGPIOValue(result)) {
+    } else if (check(PSTR("IO_"))) {
+        GPIOId id = GPIOId::None;
+        if (!scanGPIOId(id)) {
+            // Error output from `scanGPIOId()`
             return false;
         }
-        isTrue = false;
+        operand = Operand(OperandType::GPIO, (u32)id);
         return true;
     } else {
-        printErrorUnexpectedChar("Error 1-13");
+        printErrorUnexpectedChar(13);
         return false;
     }
 }
 
 bool Scanner::scanConditional() {
+    ConditionalKeyword keyword = checkConditionalKeyword();
+
     // If it starts with else its part of a conditional where one part was already rendered
-    if (check("else")) {
+    if (keyword == ConditionalKeyword::ElseIf
+        || keyword == ConditionalKeyword::ElseUnless
+        || keyword == ConditionalKeyword::Else) {
         // While parts of this conditional exist, ignore them
-        while (check("else")) {
+        while (check(PSTR("else"))) {
             // Ignore this line until the '\n'
-            while (!check('\n')) {
-                ignore();
-            }
-
-            while (nextLineIndentationIsHigher()) {
-                // Ignore the '\n' of the current line
-                ignore();
+            ignoreLine();
 
-                // Ignore the next line until the '\n'
-                while (!check('\n')) {
-                    ignore();
-                }
-            }
+            // Ignore all lines with a higher indentation
+            ignoreIndentedLines();
         }
 
         return true;
     }
 
     // Ignore a new conditional until a part that should be rendered is encountered
-    while (check("if") || check("unless") || check("else")) {
-        if (check("if") || check("else if")) {
+    while (keyword != ConditionalKeyword::None) {
+        if (keyword == ConditionalKeyword::If
+            || keyword == ConditionalKeyword::ElseIf) {
             // Ignore the "if" (or the "else if") and following whitespaces
-            if (check("if")) {
+            if (keyword == ConditionalKeyword::If) {
                 ignore(2);
             } else {
                 ignore(7);
             }
             ignoreWhitespaces();
 
-            // Evaluate the expression
-            bool exprResult = false;
-            if (!scanExpression(exprResult)) {
+            // Scan and evaluate the expression
+            Expression expression = Expression();
+            if (!scanExpression(expression)) {
                 // Error output from `scanExpression()`
                 return false;
             }
+            bool exprResult = decide(expression);
 
             // Ignore the following whitespace and the ':'
             ignoreWhitespaces();
-            if (!check(":\n")) {
-                printErrorUnexpectedChar("Error 1-14");
+            if (!check(PSTR(":\n"))) {
+                printErrorUnexpectedChar(14);
                 return false;
             } else {
                 ignore();
@@ -1043,47 +1248,40 @@ bool Scanner::scanConditional() {
 
             // If the exrpession evaluated to true, we are done
             if (exprResult) {
-                indentations_.push_back(Indentation(IndentationType::Conditional
-                ));
+                pushIndentation(Indentation(IndentationType::Conditional));
                 return true;
             }
 
             // Expression is false, ignore all indented parts
-            while (nextLineIndentationIsHigher()) {
-                // Ignore the '\n' of the current line
-                ignore();
-
-                // Ignore the next line until the '\n'
-                while (!check('\n')) {
-                    ignore();
-                }
-            }
+            ignoreIndentedLines();
 
             // Check if the next line is part of the same conditional
             if (nextLineIsPartOfSameConditional()) {
                 // If so ignore the newline and whitespaces till the else
                 ignoreWhitespaces(true);
             }
-        } else if (check("unless") || check("else unless")) {
+        } else if (keyword == ConditionalKeyword::Unless
+                   || keyword == ConditionalKeyword::ElseUnless) {
             // Ignore the "unless" (or the "else unless") and following whitespaces
-            if (check("unless")) {
+            if (keyword == ConditionalKeyword::Unless) {
                 ignore(6);
             } else {
                 ignore(11);
             }
             ignoreWhitespaces();
 
-            // Evaluate the expression
-            bool exprResult = false;
-            if (!scanExpression(exprResult)) {
+            // Scan and evaluate the expression
+            Expression expression = Expression();
+            if (!scanExpression(expression)) {
                 // Error output from `scanExpression()`
                 return false;
             }
+            bool exprResult = decide(expression);
 
             // Ignore the following whitespace and the ':'
             ignoreWhitespaces();
-            if (!check(":\n")) {
-                printErrorUnexpectedChar("Error 1-15");
+            if (!check(PSTR(":\n"))) {
+                printErrorUnexpectedChar(15);
                 return false;
             } else {
                 ignore();
@@ -1091,46 +1289,39 @@ bool Scanner::scanConditional() {
 
             // If the exrpession evaluated to false, we are done
             if (!exprResult) {
-                indentations_.push_back(Indentation(IndentationType::Conditional
-                ));
+                pushIndentation(Indentation(IndentationType::Conditional));
                 return true;
             }
 
             // Expression is true, ignore all indented parts
-            while (nextLineIndentationIsHigher()) {
-                // Ignore the '\n' of the current line
-                ignore();
-
-                // Ignore the next line until the '\n'
-                while (!check('\n')) {
-                    ignore();
-                }
-            }
+            ignoreIndentedLines();
 
             // Check if the next line is part of the same conditional
             if (nextLineIsPartOfSameConditional()) {
                 // If so ignore the newline and whitespaces till the else
                 ignoreWhitespaces(true);
             }
-        } else if (check("else")) {
+        } else if (keyword == ConditionalKeyword::Else) {
             // Ignore the "else", following whitespace, and the ':'
             ignore(4);
             ignoreWhitespaces();
-            if (!check(":\n")) {
-                printErrorUnexpectedChar("Error 1-16");
+            if (!check(PSTR(":\n"))) {
+                printErrorUnexpectedChar(16);
                 return false;
             } else {
                 ignore();
             }
 
             // We are done
-            indentations_.push_back(Indentation(IndentationType::Conditional));
+            pushIndentation(Indentation(IndentationType::Conditional));
             return true;
         }
+
+        keyword = checkConditionalKeyword();
     }
 
     if (!check('\n')) {
-        printErrorUnexpectedChar("Error 1-17");
+        printErrorUnexpectedChar(17);
         return false;
     }
     return true;
@@ -1,9 +1,17 @@
 #ifndef SCANNER_H
 #define SCANNER_H
 
-#include <LittleFS.h>
+#include <reader/reader.h>
 #include <token/token.h>
 
+class Compiler;
+
+/**
+ * @brief How many runs of Indent/Dedent Tokens a part can hold.
+ *        A part has at most one run, either an Indent or Dedents
+ */
+#define AALEC_PUG_TOKEN_RUNS 2
+
 /**
  * @brief Different types of indentations
  */
@@ -14,6 +22,31 @@ enum class IndentationType {
     Conditional,
 };
 
+/**
+ * @brief Keywords and markers that decide what kind of part follows
+ */
+enum class Keyword {
+    None,
+    Doctype,
+    Text,
+    IgnoredComment,
+    Comment,
+    Include,
+    Conditional,
+};
+
+/**
+ * @brief Keywords that start a part of a conditional
+ */
+enum class ConditionalKeyword {
+    None,
+    If,
+    Unless,
+    ElseIf,
+    ElseUnless,
+    Else,
+};
+
 /**
  * @brief Info about the an indentation level
  */
@@ -38,20 +71,66 @@ class Indentation {
     Indentation(IndentationType type, int size = 0);
 };
 
+/**
+ * @brief Everything the Scanner keeps between two parts.
+ *        Restoring it continues scanning from that part again
+ */
+class ScannerState {
+   public:
+    /**
+     * @brief Position in the source
+     */
+    size_t position;
+
+    /**
+     * @brief The character that is used for indentation
+     */
+    char indentationChar;
+
+    /**
+     * @brief Info about the indentation levels
+     */
+    ArenaVector<Indentation> indentations;
+
+    /**
+     * @brief Total size of all indentation levels
+     */
+    int indentationSize;
+
+    /**
+     * @brief Wheter we are in a Block in a Tag Text
+     */
+    bool inBlockInATag;
+
+    /**
+     * @brief Wheter we are in an Interpolation
+     */
+    int interpolationLevel;
+
+    /**
+     * @brief Compare the state to another state
+     *
+     * @param state The state that is being compared
+     * @return bool If the states match
+     */
+    bool equals(const ScannerState &state) const;
+};
+
 /**
  * @brief Scanner class that tokenizes a .pug file
  */
 class Scanner {
    private:
     /**
-     * @brief The path to the source file that is being tokenized
+     * @brief The host microbenchmarks (extras/benchmark) time the private
+     *        functions one by one
      */
-    String inPath_;
+    friend class MicroBenchmark;
 
     /**
-     * @brief Position the scanner was at when the if finished scanning the last part
+     * @brief The path to the source file that is being tokenized
      */
-    int lastPosition_;
+    String inPath_;
 
     /**
      * @brief The character that is used for indentation.
@@ -62,7 +141,13 @@ class Scanner {
     /**
      * @brief Info about the indentation levels
      */
-    std::vector<Indentation> indentations_;
+    ArenaVector<Indentation> indentations_;
+
+    /**
+     * @brief Total size of all indentation levels.
+     *        Kept up to date by `pushIndentation()` and `popIndentation()`
+     */
+    int indentationSize_;
 
     /**
      * @brief Wheter we are in a Block in a Tag Text
@@ -76,36 +161,142 @@ class Scanner {
     int interpolationLevel_;
 
     /**
-     * @brief The source file that is being tokenized
+     * @brief Reader for the source file that is being tokenized.
+     *        Stays open from the first part until the scanner is destroyed
+     */
+    Reader reader_;
+
+    /**
+     * @brief The GPIO values of the render, nullptr while compiling
+     */
+    GPIOSnapshot *gpios_;
+
+    /**
+     * @brief The compiler if the source is compiled into a program, otherwise nullptr.
+     *        GPIO values are left to the program then
+     */
+    Compiler *compiler_;
+
+    /**
+     * @brief GPIO values in the text of the current part
+     */
+    ArenaVector<Interpolation> interpolations_;
+
+    /**
+     * @brief The Indent/Dedent Tokens of the current part that weren't pulled yet
+     */
+    TokenRun runs_[AALEC_PUG_TOKEN_RUNS];
+
+    /**
+     * @brief Amount of runs in the current part
      */
-    File inFile_;
+    size_t runCount_;
+
+    /**
+     * @brief The run that is pulled next
+     */
+    size_t runIndex_;
+
+    /**
+     * @brief The Token of the current part after the runs (eg: a Tag Token)
+     */
+    Token token_;
+
+    /**
+     * @brief Wether `token_` wasn't pulled yet
+     */
+    bool hasToken_;
+
+    /**
+     * @brief The end of the current part, TokenType::EndOfPart or TokenType::EndOfSource
+     */
+    TokenType end_;
+
+    /**
+     * @brief Wether `end_` wasn't pulled yet
+     */
+    bool hasEnd_;
 
    public:
     /**
      * @brief Construct a new Scanner object
      *
      * @param inPath Path to the .pug file
+     * @param gpios The GPIO values of the render
+     */
+    Scanner(String inPath, GPIOSnapshot &gpios);
+
+    /**
+     * @brief Construct a new Scanner object that leaves the GPIO values to a program
+     *
+     * @param inPath Path to the .pug file
+     * @param compiler The compiler the source is compiled with
+     */
+    Scanner(String inPath, Compiler &compiler);
+
+    /**
+     * @brief Get the state between two parts
+     *
+     * @return ScannerState The state
+     */
+    ScannerState state();
+
+    /**
+     * @brief Continue scanning from a previous state
+     *
+     * @param state The state returned by `state()`
      */
-    Scanner(String inPath);
+    void restore(const ScannerState &state);
 
     /**
-     * @brief Scan part of the source and return the tokens
+     * @brief Scan part of the source, its tokens are pulled with `nextToken()`.
+     *        Might start with Indent/Dedent Tokens,
+     *        followed by another Token,
+     *        ends with an EndOfPart or EndOfSource Token.
      *
-     * @param tokens Appends the scanned tokens to this vector.
-     *               Might start with Indent/Dedent Tokens,
-     *               followed by another Token,
-     *               ends with an EndOfPart or EndOfSource Token.
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanPart(std::vector<Token> &tokens);
+    bool scanPart();
+
+    /**
+     * @brief Pull the next token of the current part
+     *
+     * @return Token The token, an EndOfPart Token if the part has no more tokens
+     */
+    Token nextToken();
+
+    /**
+     * @brief Checks if the current part has tokens that weren't pulled yet
+     *
+     * @return bool Wether there are tokens left
+     */
+    bool hasTokens();
 
    private:
     // Helper functions
 
     /**
-     * @brief Prints the "{name}: Unexpected character (ASCII code: '{code}') at {inPath_}:{position}" message
+     * @brief Where errors are printed to, the serial output or the compiler
+     *
+     * @return Print& The output for errors
      */
-    void printErrorUnexpectedChar(String name);
+    Print &log();
+
+    /**
+     * @brief Decides on an expression.
+     *        Evaluates it, unless it depends on a GPIO while compiling
+     *
+     * @param expression The expression
+     * @return bool The result
+     */
+    bool decide(const Expression &expression);
+
+    /**
+     * @brief Prints the "Error 1-{code}: Unexpected character (ASCII code: '{char}') at {inPath_}:{position}" message
+     *
+     * @param code The number of the error
+     */
+    void printErrorUnexpectedChar(int code);
 
     /**
      * @brief Compare the nexr char in the source to the given char
@@ -118,18 +309,19 @@ class Scanner {
     /**
      * @brief Compare the next part of the source to the given string
      *
-     * @param value The string that is being compared
+     * @param value The string that is being compared, may be in flash (PROGMEM)
      * @return bool If the strings matche
      */
-    bool check(String value);
+    bool check(const char *value);
 
     /**
-     * @brief Removes the specified amount of characters from the source and returns them
+     * @brief Removes the specified amount of characters from the source and appends them to the value.
+     *        If the source is in memory the value views into it instead of copying
      *
+     * @param value The value to append the removed characters to
      * @param amount The amount of characters to remove, defaults to 1
-     * @return String The removed characters
      */
-    String consume(int amount = 1);
+    void consume(SourceString &value, int amount = 1);
 
     /**
      * @brief Removes the specified amount of characters from the source
@@ -145,6 +337,17 @@ class Scanner {
      */
     void ignoreWhitespaces(bool includeNewlines = false);
 
+    /**
+     * @brief Ignores everything up until the next '\n' (not included)
+     */
+    void ignoreLine();
+
+    /**
+     * @brief Ignores all following lines that are indented more than the current line.
+     *        Expects a '\n' at the beginning
+     */
+    void ignoreIndentedLines();
+
     /**
      * @brief Checks if the source starts with a whitespace (32: ' ', 9: '\t')
      *
@@ -195,16 +398,63 @@ class Scanner {
      */
     bool nextLineIsPartOfSameConditional();
 
+    /**
+     * @brief Counts the indentation chars at the offset without removing them
+     *
+     * @param offset Distance from the current position
+     * @return int The amount of indentation chars
+     */
+    int countIndentation(size_t offset);
+
+    /**
+     * @brief Adds an indentation level
+     *
+     * @param indentation The new level
+     */
+    void pushIndentation(Indentation indentation);
+
+    /**
+     * @brief Removes the last indentation level
+     */
+    void popIndentation();
+
+    /**
+     * @brief Classifies the start of a part in one pass over the source, without removing anything
+     *
+     * @return Keyword The keyword the part starts with, Keyword::None for tags and everything else
+     */
+    Keyword checkKeyword();
+
+    /**
+     * @brief Classifies the start of a conditional in one pass over the source, without removing anything
+     *
+     * @return ConditionalKeyword The keyword, ConditionalKeyword::None if it isn't a conditional
+     */
+    ConditionalKeyword checkConditionalKeyword();
+
+    /**
+     * @brief Classifies a GPIO ID in one pass over the source, without removing anything
+     *
+     * @return GPIOId The GPIO ID, GPIOId::None if it isn't a known one
+     */
+    GPIOId checkGPIOId();
+
     // Scan related funcitons
 
     /**
      * @brief Scans indentation.
      *        Expects a whitespace at the beginning
      *
-     * @param tokens Appends the Indent/Dedent Tokens to this vector
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanIndentation(std::vector<Token> &tokens);
+    bool scanIndentation();
+
+    /**
+     * @brief Add an Indent or Dedent Token to the current part
+     *
+     * @param type TokenType::Indent or TokenType::Dedent
+     */
+    void pushRun(TokenType type);
 
     /**
      * @brief Scans a doctype tag.
@@ -231,7 +481,7 @@ class Scanner {
      * @param attributes Appends the attributes to this vector
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanTagAttributes(std::vector<Attribute> &attributes);
+    bool scanTagAttributes(ArenaVector<Attribute> &attributes);
 
     /**
      * @brief Scans the inner text of a tag.
@@ -240,7 +490,7 @@ class Scanner {
      * @param value The scanned text
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanTagText(String &value);
+    bool scanTagText(SourceString &value);
 
     /**
      * @brief Scans the inline inner text of a tag.
@@ -249,7 +499,7 @@ class Scanner {
      * @param value The scanned text
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanTagTextInline(String &value);
+    bool scanTagTextInline(SourceString &value);
 
     /**
      * @brief Scans the block in a tag inner text of a tag.
@@ -258,7 +508,7 @@ class Scanner {
      * @param value The scanned text
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanTagTextBlock(String &value);
+    bool scanTagTextBlock(SourceString &value);
 
     /**
      * @brief Scans the next part of the tag text and appends it to the value.
@@ -266,7 +516,7 @@ class Scanner {
      * @param value The scanned text is appended to this string
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanTagTextPart(String &value);
+    bool scanTagTextPart(SourceString &value);
 
     /**
      * @brief Scans Text.
@@ -331,32 +581,31 @@ class Scanner {
     bool scanInclude(IncludeData &data);
 
     /**
-     * @brief Gets the value of a GPIO Pin.
+     * @brief Scans a GPIO ID.
      *        Expects "IO_" at the beginning
      *
-     * @param result Value of the GPIO Pin
+     * @param id The GPIO ID
      * @return bool Wether scanning was successfull, see serial output for errors
      */
-    bool scanGPIOValue(uint &result);
+    bool scanGPIOId(GPIOId &id);
 
     /**
-     * @brief Evaluates an expression.
+     * @brief Scans an expression without evaluating it.
      *        Expects a '(', "True", "False", "IO_", or digit at the beginning
      *
-     * @param result Result of the expression evaluation
+     * @param expression Location to write the expression to
      * @return bool Wether scanning was successfull, see the serial output for more information
      */
-    bool scanExpression(bool &result);
+    bool scanExpression(Expression &expression);
 
     /**
-     * @brief Evaluates an expression.
+     * @brief Scans a key of an expression.
      *        Expects a "True", "False", "IO_", or digit at the beginning
      *
-     * @param result Result of the expression evaluation
-     * @param isTrue Wheter the expression was `True`
-     * @return bool Wheter evaluation was successfull, see serial output for errors
+     * @param operand Location to write the key to
+     * @return bool Wheter scanning was successfull, see serial output for errors
      */
-    bool scanExpressionEvaluate(u32 &result, bool &isTrue);
+    bool scanOperand(Operand &operand);
 
     /**
      * @brief Scans a conditional.
@@ -0,0 +1,265 @@
+#include "tag.h"
+
+/**
+ * @brief Flag of tags that are void elements
+ */
+#define TAG_VOID 1
+
+/**
+ * @brief Flag of tags whose text is raw text
+ */
+#define TAG_RAW_TEXT 2
+
+/**
+ * @brief Size of the hash index of the tag table, a power of two
+ */
+#define TAG_INDEX_SIZE 256
+
+/**
+ * @brief Size of the longest name in the tag table with its null terminator
+ */
+#define TAG_NAME_SIZE 11
+
+/**
+ * @brief A tag of the tag table. The text is stored in the entry,
+ *        so the whole table can stay in flash
+ */
+class TagInfo {
+   public:
+    /**
+     * @brief The name of the tag
+     */
+    char name[TAG_NAME_SIZE];
+
+    /**
+     * @brief The closing tag
+     */
+    char closing[TAG_NAME_SIZE + 3];
+
+    /**
+     * @brief Length of the name
+     */
+    uint8_t length;
+
+    /**
+     * @brief TAG_VOID and TAG_RAW_TEXT
+     */
+    uint8_t flags;
+};
+
+/**
+ * @brief An entry of the tag table with its precomputed closing tag
+ */
+#define TAG(name, flags) {name, "</" name ">", sizeof(name) - 1, flags}
+
+/**
+ * @brief The known HTML tags, indexed by their TagId, in flash
+ */
+static constexpr TagInfo tagTable[] PROGMEM = {
+    // AALEC_PUG_TAG_NONE and AALEC_PUG_TAG_UNKNOWN
+    {"", "", 0, 0},
+    {"", "", 0, 0},
+
+    TAG("a", 0),
+    TAG("abbr", 0),
+    TAG("address", 0),
+    TAG("area", TAG_VOID),
+    TAG("article", 0),
+    TAG("aside", 0),
+    TAG("audio", 0),
+    TAG("b", 0),
+    TAG("base", TAG_VOID),
+    TAG("bdi", 0),
+    TAG("bdo", 0),
+    TAG("blockquote", 0),
+    TAG("body", 0),
+    TAG("br", TAG_VOID),
+    TAG("button", 0),
+    TAG("canvas", 0),
+    TAG("caption", 0),
+    TAG("cite", 0),
+    TAG("code", 0),
+    TAG("col", TAG_VOID),
+    TAG("colgroup", 0),
+    TAG("data", 0),
+    TAG("datalist", 0),
+    TAG("dd", 0),
+    TAG("del", 0),
+    TAG("details", 0),
+    TAG("dfn", 0),
+    TAG("dialog", 0),
+    TAG("div", 0),
+    TAG("dl", 0),
+    TAG("dt", 0),
+    TAG("em", 0),
+    TAG("embed", TAG_VOID),
+    TAG("fieldset", 0),
+    TAG("figcaption", 0),
+    TAG("figure", 0),
+    TAG("footer", 0),
+    TAG("form", 0),
+    TAG("h1", 0),
+    TAG("h2", 0),
+    TAG("h3", 0),
+    TAG("h4", 0),
+    TAG("h5", 0),
+    TAG("h6", 0),
+    TAG("head", 0),
+    TAG("header", 0),
+    TAG("hgroup", 0),
+    TAG("hr", TAG_VOID),
+    TAG("html", 0),
+    TAG("i", 0),
+    TAG("iframe", 0),
+    TAG("img", TAG_VOID),
+    TAG("input", TAG_VOID),
+    TAG("ins", 0),
+    TAG("kbd", 0),
+    TAG("label", 0),
+    TAG("legend", 0),
+    TAG("li", 0),
+    TAG("link", TAG_VOID),
+    TAG("main", 0),
+    TAG("map", 0),
+    TAG("mark", 0),
+    TAG("math", 0),
+    TAG("menu", 0),
+    TAG("meta", TAG_VOID),
+    TAG("meter", 0),
+    TAG("nav", 0),
+    TAG("noscript", 0),
+    TAG("object", 0),
+    TAG("ol", 0),
+    TAG("optgroup", 0),
+    TAG("option", 0),
+    TAG("output", 0),
+    TAG("p", 0),
+    TAG("param", TAG_VOID),
+    TAG("picture", 0),
+    TAG("pre", 0),
+    TAG("progress", 0),
+    TAG("q", 0),
+    TAG("rp", 0),
+    TAG("rt", 0),
+    TAG("ruby", 0),
+    TAG("s", 0),
+    TAG("samp", 0),
+    TAG("script", TAG_RAW_TEXT),
+    TAG("search", 0),
+    TAG("section", 0),
+    TAG("select", 0),
+    TAG("slot", 0),
+    TAG("small", 0),
+    TAG("source", TAG_VOID),
+    TAG("span", 0),
+    TAG("strong", 0),
+    TAG("style", TAG_RAW_TEXT),
+    TAG("sub", 0),
+    TAG("summary", 0),
+    TAG("sup", 0),
+    TAG("svg", 0),
+    TAG("table", 0),
+    TAG("tbody", 0),
+    TAG("td", 0),
+    TAG("template", 0),
+    TAG("textarea", TAG_RAW_TEXT),
+    TAG("tfoot", 0),
+    TAG("th", 0),
+    TAG("thead", 0),
+    TAG("time", 0),
+    TAG("title", TAG_RAW_TEXT),
+    TAG("tr", 0),
+    TAG("track", TAG_VOID),
+    TAG("u", 0),
+    TAG("ul", 0),
+    TAG("var", 0),
+    TAG("video", 0),
+    TAG("wbr", TAG_VOID),
+};
+
+/**
+ * @brief Amount of entries in the tag table
+ */
+#define TAG_COUNT (sizeof(tagTable) / sizeof(tagTable[0]))
+
+static_assert(TAG_COUNT < TAG_INDEX_SIZE, "The tag index must have free slots");
+
+/**
+ * @brief Slot of a name in the hash index (FNV-1a)
+ *
+ * @param name The name
+ * @param length Length of the name
+ * @return size_t The slot
+ */
+static constexpr size_t tagSlot(const char *name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash % TAG_INDEX_SIZE;
+}
+
+/**
+ * @brief Hash index of the tag table, with linear probing
+ */
+class TagIndex {
+   public:
+    /**
+     * @brief The TagIds, AALEC_PUG_TAG_NONE for free slots
+     */
+    TagId slots[TAG_INDEX_SIZE];
+};
+
+/**
+ * @brief Build the hash index of the tag table
+ *
+ * @return TagIndex The index
+ */
+static constexpr TagIndex buildTagIndex() {
+    TagIndex index = {};
+    for (size_t id = AALEC_PUG_TAG_UNKNOWN + 1; id < TAG_COUNT; id++) {
+        size_t slot = tagSlot(tagTable[id].name, tagTable[id].length);
+        while (index.slots[slot] != AALEC_PUG_TAG_NONE) {
+            slot = (slot + 1) % TAG_INDEX_SIZE;
+        }
+        index.slots[slot] = id;
+    }
+
+    return index;
+}
+
+/**
+ * @brief The hash index, built while compiling, in flash
+ */
+static constexpr TagIndex tagIndex PROGMEM = buildTagIndex();
+
+TagId tagId(const char *name, size_t length) {
+    size_t slot = tagSlot(name, length);
+    for (TagId id = pgm_read_byte(&tagIndex.slots[slot]);
+         id != AALEC_PUG_TAG_NONE;
+         id = pgm_read_byte(&tagIndex.slots[slot])) {
+        const TagInfo &tag = tagTable[id];
+        if (pgm_read_byte(&tag.length) == length
+            && memcmp_P(name, tag.name, length) == 0) {
+            return id;
+        }
+        slot = (slot + 1) % TAG_INDEX_SIZE;
+    }
+
+    return AALEC_PUG_TAG_UNKNOWN;
+}
+
+bool isVoidTag(TagId id) {
+    return id < TAG_COUNT && (pgm_read_byte(&tagTable[id].flags) & TAG_VOID);
+}
+
+bool isRawTextTag(TagId id) {
+    return id < TAG_COUNT
+        && (pgm_read_byte(&tagTable[id].flags) & TAG_RAW_TEXT);
+}
+
+PGM_P closingTag(TagId id) {
+    return tagTable[id < TAG_COUNT ? id : AALEC_PUG_TAG_NONE].closing;
+}
@@ -0,0 +1,58 @@
+#ifndef TAG_H
+#define TAG_H
+
+#include <Arduino.h>
+
+/**
+ * @brief ID of an HTML tag, its index in the tag table
+ */
+typedef uint8_t TagId;
+
+/**
+ * @brief ID of an open element that isn't closed with a tag
+ *        (eg: text, comments, void elements)
+ */
+#define AALEC_PUG_TAG_NONE 0
+
+/**
+ * @brief ID of a tag that isn't in the tag table, its name is kept separately
+ */
+#define AALEC_PUG_TAG_UNKNOWN 1
+
+/**
+ * @brief Get the ID of a tag from the tag table
+ *
+ * @param name The name of the tag, eg: "div"
+ * @param length Length of the name
+ * @return TagId The ID, AALEC_PUG_TAG_UNKNOWN if it isn't in the table
+ */
+TagId tagId(const char *name, size_t length);
+
+/**
+ * @brief Whether the tag is a void element by default
+ *        eg: img, br
+ *
+ * @param id The ID of the tag
+ * @return bool If it is a void element
+ */
+bool isVoidTag(TagId id);
+
+/**
+ * @brief Whether the text of the tag isn't parsed as HTML,
+ *        eg: script, title
+ *
+ * @param id The ID of the tag
+ * @return bool If its text is raw text
+ */
+bool isRawTextTag(TagId id);
+
+/**
+ * @brief The closing tag of a tag from the tag table
+ *
+ * @param id The ID of the tag
+ * @return PGM_P The closing tag in flash, eg: "</div>", empty for
+ *               AALEC_PUG_TAG_NONE and AALEC_PUG_TAG_UNKNOWN
+ */
+PGM_P closingTag(TagId id);
+
+#endif  // TAG_H
@@ -1,103 +1,324 @@
 #include "token.h"
 
-Token::Token(TokenType type) : type(type) {}
+SourceString::SourceString() : data_(""), length_(0), owned_() {}
+
+SourceString::SourceString(const char *value) :
+    data_(value),
+    length_(strlen(value)),
+    owned_() {}
 
-Token::Token(DoctypeData data) : type(TokenType::Doctype), doctype(data) {}
+SourceString::SourceString(const char *data, size_t length) :
+    data_(data),
+    length_(length),
+    owned_() {}
 
-Token::Token(TagData data) : type(TokenType::Tag), tag(data) {}
+const char *SourceString::data() const {
+    return data_ != nullptr ? data_ : owned_.data();
+}
+
+size_t SourceString::length() const {
+    return data_ != nullptr ? length_ : owned_.length();
+}
 
-Token::Token(TextData data) : type(TokenType::Text), text(data) {}
+bool SourceString::isEmpty() const {
+    return length() == 0;
+}
 
-Token::Token(CommentData data) : type(TokenType::Comment), comment(data) {}
+bool SourceString::equals(const char *value) const {
+    size_t valueLength = strlen_P(value);
+    return valueLength == length()
+        && memcmp_P(data(), value, valueLength) == 0;
+}
 
-Token::Token(IncludeData data) : type(TokenType::Include), include(data) {}
+bool SourceString::equals(const SourceString &value) const {
+    return value.length() == length()
+        && memcmp(data(), value.data(), length()) == 0;
+}
 
-DoctypeData::DoctypeData() : value(""), doctypeType(DoctypeShorthand::Other) {}
+String SourceString::toString() const {
+    String value = String();
+    value.concat(data(), length());
+    return value;
+}
 
-DoctypeData::DoctypeData(String value) : value(value) {
-    if (value == "html" || value == "") {
-        doctypeType = DoctypeShorthand::Html;
-    } else if (value == "xml") {
-        doctypeType = DoctypeShorthand::Xml;
-    } else if (value == "transitional") {
-        doctypeType = DoctypeShorthand::Transitional;
-    } else if (value == "strict") {
-        doctypeType = DoctypeShorthand::Strict;
-    } else if (value == "frameset") {
-        doctypeType = DoctypeShorthand::Frameset;
-    } else if (value == "1.1") {
-        doctypeType = DoctypeShorthand::OneDotOne;
-    } else if (value == "basic") {
-        doctypeType = DoctypeShorthand::Basic;
-    } else if (value == "mobile") {
-        doctypeType = DoctypeShorthand::Mobile;
-    } else if (value == "plist") {
-        doctypeType = DoctypeShorthand::Plist;
+void SourceString::extend(const char *data, size_t length) {
+    if (data_ != nullptr && length_ == 0) {
+        // Start a new view
+        data_ = data;
+        length_ = length;
+    } else if (data_ != nullptr && data_ + length_ == data) {
+        // Grow the view
+        length_ += length;
     } else {
-        doctypeType = DoctypeShorthand::Other;
+        append(data, length);
     }
 }
 
-String DoctypeData::toHTMLString() {
-    switch (doctypeType) {
-        case DoctypeShorthand::Html:
-            return "<!DOCTYPE html>";
-        case DoctypeShorthand::Xml:
-            return "<?xml version=\"1.0\" encoding=\"utf-8\" ?>";
-        case DoctypeShorthand::Transitional:
-            return "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">";
-        case DoctypeShorthand::Strict:
-            return "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">";
-        case DoctypeShorthand::Frameset:
-            return "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Frameset//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-frameset.dtd\">";
-        case DoctypeShorthand::OneDotOne:
-            return "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.1//EN\" \"http://www.w3.org/TR/xhtml11/DTD/xhtml11.dtd\">";
-        case DoctypeShorthand::Basic:
-            return "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML Basic 1.1//EN\" \"http://www.w3.org/TR/xhtml-basic/xhtml-basic11.dtd\">";
-        case DoctypeShorthand::Mobile:
-            return "<!DOCTYPE html PUBLIC \"-//WAPFORUM//DTD XHTML Mobile 1.2//EN\" \"http://www.openmobilealliance.org/tech/DTD/xhtml-mobile12.dtd\">";
-        case DoctypeShorthand::Plist:
-            return "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">";
-        default:
-            return "<!DOCTYPE " + value + ">";
+void SourceString::append(const char *data, size_t length) {
+    // Turn the view into an owned copy
+    if (data_ != nullptr) {
+        owned_.reserve(length_ + length);
+        owned_.append(data_, length_);
+        data_ = nullptr;
+        length_ = 0;
+    }
+
+    owned_.append(data, length);
+}
+
+void SourceString::append(const char *value) {
+    append(value, strlen(value));
+}
+
+void SourceString::append(char value) {
+    append(&value, 1);
+}
+
+Interpolation::Interpolation(size_t offset, GPIOId id) :
+    offset(offset),
+    id(id) {}
+
+DoctypeData::DoctypeData() : value(), doctypeType(DoctypeShorthand::Other) {}
+
+// The doctype text is kept in flash, only the shorthand that is used is read
+static const char doctypeShorthand0[] PROGMEM = "html";
+static const char doctypeShorthand1[] PROGMEM = "xml";
+static const char doctypeShorthand2[] PROGMEM = "transitional";
+static const char doctypeShorthand3[] PROGMEM = "strict";
+static const char doctypeShorthand4[] PROGMEM = "frameset";
+static const char doctypeShorthand5[] PROGMEM = "1.1";
+static const char doctypeShorthand6[] PROGMEM = "basic";
+static const char doctypeShorthand7[] PROGMEM = "mobile";
+static const char doctypeShorthand8[] PROGMEM = "plist";
+
+/**
+ * @brief The doctype shorthands, indexed by DoctypeShorthand
+ */
+static const char *const doctypeShorthands[] PROGMEM = {
+    doctypeShorthand0,
+    doctypeShorthand1,
+    doctypeShorthand2,
+    doctypeShorthand3,
+    doctypeShorthand4,
+    doctypeShorthand5,
+    doctypeShorthand6,
+    doctypeShorthand7,
+    doctypeShorthand8,
+};
+
+static const char doctypeHTML0[] PROGMEM = "<!DOCTYPE html>";
+static const char doctypeHTML1[] PROGMEM =
+    "<?xml version=\"1.0\" encoding=\"utf-8\" ?>";
+static const char doctypeHTML2[] PROGMEM = "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">";
+static const char doctypeHTML3[] PROGMEM = "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">";
+static const char doctypeHTML4[] PROGMEM = "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Frameset//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-frameset.dtd\">";
+static const char doctypeHTML5[] PROGMEM = "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.1//EN\" \"http://www.w3.org/TR/xhtml11/DTD/xhtml11.dtd\">";
+static const char doctypeHTML6[] PROGMEM = "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML Basic 1.1//EN\" \"http://www.w3.org/TR/xhtml-basic/xhtml-basic11.dtd\">";
+static const char doctypeHTML7[] PROGMEM = "<!DOCTYPE html PUBLIC \"-//WAPFORUM//DTD XHTML Mobile 1.2//EN\" \"http://www.openmobilealliance.org/tech/DTD/xhtml-mobile12.dtd\">";
+static const char doctypeHTML8[] PROGMEM = "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">";
+
+/**
+ * @brief The HTML of the doctype shorthands, indexed by DoctypeShorthand
+ */
+static const char *const doctypeHTML[] PROGMEM = {
+    doctypeHTML0,
+    doctypeHTML1,
+    doctypeHTML2,
+    doctypeHTML3,
+    doctypeHTML4,
+    doctypeHTML5,
+    doctypeHTML6,
+    doctypeHTML7,
+    doctypeHTML8,
+};
+
+DoctypeData::DoctypeData(SourceString value) :
+    value(value),
+    doctypeType(DoctypeShorthand::Other) {
+    if (value.isEmpty()) {
+        doctypeType = DoctypeShorthand::Html;
+        return;
+    }
+
+    for (size_t i = 0; i < (size_t)DoctypeShorthand::Other; i++) {
+        PGM_P shorthand = (PGM_P)pgm_read_ptr(&doctypeShorthands[i]);
+        if (value.equals(shorthand)) {
+            doctypeType = (DoctypeShorthand)i;
+            return;
+        }
     }
 }
 
-Attribute::Attribute() : key(""), booleanAttribute(false), value("") {}
+void DoctypeData::print(Print &out) const {
+    if (doctypeType == DoctypeShorthand::Other) {
+        out.print(F("<!DOCTYPE "));
+        out.write((const uint8_t *)value.data(), value.length());
+        out.print('>');
+        return;
+    }
+
+    // Streamed from flash
+    out.print(FPSTR(pgm_read_ptr(&doctypeHTML[(size_t)doctypeType])));
+}
 
-Attribute::Attribute(String key) :
-    key(key),
+Attribute::Attribute() : key(), booleanAttribute(false), value() {}
+
+Attribute::Attribute(SourceString key) :
+    key(std::move(key)),
     booleanAttribute(true),
-    value("") {}
+    value() {}
 
-Attribute::Attribute(String key, String value) :
-    key(key),
+Attribute::Attribute(SourceString key, SourceString value) :
+    key(std::move(key)),
     booleanAttribute(false),
-    value(value) {}
+    value(std::move(value)) {}
 
-TagData::TagData() : name(""), attributes(), isVoidElement(false), text("") {}
+TagData::TagData() :
+    name(),
+    attributes(),
+    isVoidElement(false),
+    text(),
+    interpolations() {}
 
 TagData::TagData(
-    String name,
-    std::vector<Attribute> attributes,
+    SourceString name,
+    ArenaVector<Attribute> attributes,
     bool isVoidElement,
-    String text
+    SourceString text,
+    ArenaVector<Interpolation> interpolations
 ) :
-    name(name),
-    attributes(attributes),
+    name(std::move(name)),
+    attributes(std::move(attributes)),
     isVoidElement(isVoidElement),
-    text(text) {}
+    text(std::move(text)),
+    interpolations(std::move(interpolations)) {}
 
-TextData::TextData() : value(""), textType(TextType::InnerText) {}
+TextData::TextData() :
+    value(),
+    textType(TextType::InnerText),
+    interpolations() {}
 
-TextData::TextData(String value, TextType textType) :
-    value(value),
-    textType(textType) {}
+TextData::TextData(
+    SourceString value,
+    TextType textType,
+    ArenaVector<Interpolation> interpolations
+) :
+    value(std::move(value)),
+    textType(textType),
+    interpolations(std::move(interpolations)) {}
+
+CommentData::CommentData() : value() {}
+
+CommentData::CommentData(SourceString value) : value(std::move(value)) {}
+
+IncludeData::IncludeData() : path() {}
 
-CommentData::CommentData() : value("") {}
+IncludeData::IncludeData(SourceString path) : path(std::move(path)) {}
 
-CommentData::CommentData(String value) : value(value) {}
+TokenRun::TokenRun() : type(TokenType::Indent), count(0) {}
 
-IncludeData::IncludeData() : path("") {}
+TokenRun::TokenRun(TokenType type, size_t count) : type(type), count(count) {}
 
-IncludeData::IncludeData(String path) : path(path) {}
+Token::Token(TokenType type) : type(type) {}
+
+Token::Token(DoctypeData data) : type(TokenType::Doctype) {
+    new (&doctype_) DoctypeData(std::move(data));
+}
+
+Token::Token(TagData data) : type(TokenType::Tag) {
+    new (&tag_) TagData(std::move(data));
+}
+
+Token::Token(TextData data) : type(TokenType::Text) {
+    new (&text_) TextData(std::move(data));
+}
+
+Token::Token(CommentData data) : type(TokenType::Comment) {
+    new (&comment_) CommentData(std::move(data));
+}
+
+Token::Token(IncludeData data) : type(TokenType::Include) {
+    new (&include_) IncludeData(std::move(data));
+}
+
+Token::Token(Token &&token) : type(token.type) {
+    moveData(std::move(token));
+}
+
+Token::~Token() {
+    destroyData();
+}
+
+Token &Token::operator=(Token &&token) {
+    if (this != &token) {
+        destroyData();
+        type = token.type;
+        moveData(std::move(token));
+    }
+
+    return *this;
+}
+
+DoctypeData &Token::doctype() {
+    return doctype_;
+}
+
+TagData &Token::tag() {
+    return tag_;
+}
+
+TextData &Token::text() {
+    return text_;
+}
+
+CommentData &Token::comment() {
+    return comment_;
+}
+
+IncludeData &Token::include() {
+    return include_;
+}
+
+void Token::moveData(Token &&token) {
+    switch (type) {
+        case TokenType::Doctype:
+            new (&doctype_) DoctypeData(std::move(token.doctype_));
+            break;
+        case TokenType::Tag:
+            new (&tag_) TagData(std::move(token.tag_));
+            break;
+        case TokenType::Text:
+            new (&text_) TextData(std::move(token.text_));
+            break;
+        case TokenType::Comment:
+            new (&comment_) CommentData(std::move(token.comment_));
+            break;
+        case TokenType::Include:
+            new (&include_) IncludeData(std::move(token.include_));
+            break;
+        default:
+            break;
+    }
+}
+
+void Token::destroyData() {
+    switch (type) {
+        case TokenType::Doctype:
+            doctype_.~DoctypeData();
+            break;
+        case TokenType::Tag:
+            tag_.~TagData();
+            break;
+        case TokenType::Text:
+            text_.~TextData();
+            break;
+        case TokenType::Comment:
+            comment_.~CommentData();
+            break;
+        case TokenType::Include:
+            include_.~IncludeData();
+            break;
+        default:
+            break;
+    }
+}
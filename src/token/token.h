@@ -2,9 +2,20 @@
 #define TOKEN_H
 
 #include <Arduino.h>
+#include <arena/arena.h>
+#include <gpio/gpio.h>
 
 #include <vector>
 
+/**
+ * @brief Largest size of a Token in bytes, the Scanner keeps several of them.
+ *        112 bytes on the 32 bit ESP8266, 192 bytes on 64 bit hosts.
+ *        Can be overwritten with a build flag
+ */
+#ifndef AALEC_PUG_TOKEN_MAX_SIZE
+    #define AALEC_PUG_TOKEN_MAX_SIZE (sizeof(void *) == 4 ? 112 : 192)
+#endif
+
 /**
  * @brief All types of tokens that can be found in the source code
  */
@@ -45,6 +56,153 @@ enum class TextType {
     InnerText,
 };
 
+/**
+ * @brief A string in a token.
+ *        Usually a view into the source that was loaded into memory,
+ *        becomes an owned copy when it can't be represented as one view
+ *        (eg: escaped characters, GPIO values, or text over multiple lines)
+ */
+class SourceString {
+   private:
+    /**
+     * @brief Start of the viewed characters, nullptr if the string is owned
+     */
+    const char *data_;
+
+    /**
+     * @brief Amount of viewed characters
+     */
+    size_t length_;
+
+    /**
+     * @brief The owned copy, only used if data_ is nullptr
+     */
+    ArenaString owned_;
+
+   public:
+    /**
+     * @brief Construct a new empty Source String object
+     */
+    SourceString();
+
+    /**
+     * @brief Construct a new Source String object viewing a null terminated string.
+     *        The string must outlive this object (eg: a string literal)
+     *
+     * @param value The viewed string
+     */
+    SourceString(const char *value);
+
+    /**
+     * @brief Construct a new Source String object viewing characters.
+     *        The characters must outlive this object
+     *
+     * @param data Start of the viewed characters
+     * @param length Amount of viewed characters
+     */
+    SourceString(const char *data, size_t length);
+
+    /**
+     * @brief The characters of the string, not null terminated
+     *
+     * @return const char* Start of the characters
+     */
+    const char *data() const;
+
+    /**
+     * @brief The length of the string
+     *
+     * @return size_t The amount of characters
+     */
+    size_t length() const;
+
+    /**
+     * @brief Checks if the string is empty
+     *
+     * @return bool Wether the string is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Compare the string to a null terminated string
+     *
+     * @param value The string that is being compared, may be in flash (PROGMEM)
+     * @return bool If the strings match
+     */
+    bool equals(const char *value) const;
+
+    /**
+     * @brief Compare the string to another source string
+     *
+     * @param value The string that is being compared
+     * @return bool If the strings match
+     */
+    bool equals(const SourceString &value) const;
+
+    /**
+     * @brief Create an Arduino String copy
+     *
+     * @return String The copy
+     */
+    String toString() const;
+
+    /**
+     * @brief Append characters that directly follow the viewed characters
+     *        without copying, falls back to `append()` if they don't
+     *
+     * @param data Start of the characters
+     * @param length Amount of characters
+     */
+    void extend(const char *data, size_t length);
+
+    /**
+     * @brief Append characters, turns the string into an owned copy
+     *
+     * @param data Start of the characters
+     * @param length Amount of characters
+     */
+    void append(const char *data, size_t length);
+
+    /**
+     * @brief Append a null terminated string, turns the string into an owned copy
+     *
+     * @param value The string
+     */
+    void append(const char *value);
+
+    /**
+     * @brief Append a character, turns the string into an owned copy
+     *
+     * @param value The character
+     */
+    void append(char value);
+};
+
+/**
+ * @brief A GPIO value that is inserted into a text when the text is written,
+ *        by the Parser or by the program
+ */
+class Interpolation {
+   public:
+    /**
+     * @brief Position in the text where the value is inserted
+     */
+    size_t offset;
+
+    /**
+     * @brief The GPIO whose value is inserted
+     */
+    GPIOId id;
+
+    /**
+     * @brief Construct a new Interpolation object
+     *
+     * @param offset Position in the text where the value is inserted
+     * @param id The GPIO whose value is inserted
+     */
+    Interpolation(size_t offset, GPIOId id);
+};
+
 /**
  * @brief Data about a doctype token
  */
@@ -53,7 +211,7 @@ class DoctypeData {
     /**
      * @brief The value of the doctype as found in the source code
      */
-    String value;
+    SourceString value;
 
     /**
      * @brief What shortcut was used
@@ -70,15 +228,15 @@ class DoctypeData {
      *
      * @param value The value of the doctype as found in the source code
      */
-    DoctypeData(String value);
+    DoctypeData(SourceString value);
 
     /**
-     * @brief Convert the doctype token to an HTML string
+     * @brief Write the HTML of the doctype, the shorthands are read from flash
+     *        eg: `<!DOCTYPE html>` or `<?xml version="1.0" encoding="utf-8" ?>`
      *
-     * @return String The HTML string representation of the doctype token
-     *                     eg: `<!DOCTYPE html>` or `<?xml version="1.0" encoding="utf-8" ?>`
+     * @param out Where the HTML is written to
      */
-    String toHTMLString();
+    void print(Print &out) const;
 };
 
 /**
@@ -89,7 +247,7 @@ class Attribute {
     /**
      * @brief The key of the attribute
      */
-    String key;
+    SourceString key;
 
     /**
      * @brief Wether the attribute is a true boolean attribute or a key value attribute
@@ -100,7 +258,7 @@ class Attribute {
      * @brief When the attribute is not a boolean attribute:
      *        The value of the attribute
      */
-    String value;
+    SourceString value;
 
     /**
      * @brief Construct a new empty Attribute object
@@ -112,7 +270,7 @@ class Attribute {
      *
      * @param key The key of the attribute
      */
-    Attribute(String key);
+    Attribute(SourceString key);
 
     /**
      * @brief Construct a new Attribute object, when its a key value attribute
@@ -120,7 +278,7 @@ class Attribute {
      * @param key The key of the attribute
      * @param value The value of the attribute
      */
-    Attribute(String key, String value);
+    Attribute(SourceString key, SourceString value);
 };
 
 /**
@@ -131,12 +289,12 @@ class TagData {
     /**
      * @brief The name of the tag
      */
-    String name;
+    SourceString name;
 
     /**
      * @brief The attributes of the tag
      */
-    std::vector<Attribute> attributes;
+    ArenaVector<Attribute> attributes;
 
     /**
      * @brief If the tag is forced to be a void element
@@ -146,7 +304,12 @@ class TagData {
     /**
      * @brief The inner text of the tag
      */
-    String text;
+    SourceString text;
+
+    /**
+     * @brief GPIO values in the inner text, see `Interpolation`
+     */
+    ArenaVector<Interpolation> interpolations;
 
     /**
      * @brief Construct a new empty Tag Data object
@@ -160,12 +323,14 @@ class TagData {
      * @param attributes The attributes of the tag
      * @param isVoidElement If the tag is forced to be a void element
      * @param text The inner text of the tag
+     * @param interpolations GPIO values in the inner text, defaults to none
      */
     TagData(
-        String name,
-        std::vector<Attribute> attributes,
+        SourceString name,
+        ArenaVector<Attribute> attributes,
         bool isVoidElement,
-        String text
+        SourceString text,
+        ArenaVector<Interpolation> interpolations = ArenaVector<Interpolation>()
     );
 };
 
@@ -177,13 +342,18 @@ class TextData {
     /**
      * @brief The value of the token
      */
-    String value;
+    SourceString value;
 
     /**
      * @brief Text type of this Text Token
      */
     TextType textType;
 
+    /**
+     * @brief GPIO values in the value, see `Interpolation`
+     */
+    ArenaVector<Interpolation> interpolations;
+
     /**
      * @brief Construct a new empty Text Data object
      */
@@ -194,8 +364,13 @@ class TextData {
      *
      * @param value The value of the token
      * @param textType Text type of this Text Token
+     * @param interpolations GPIO values in the value, defaults to none
      */
-    TextData(String value, TextType textType);
+    TextData(
+        SourceString value,
+        TextType textType,
+        ArenaVector<Interpolation> interpolations = ArenaVector<Interpolation>()
+    );
 };
 
 /**
@@ -206,7 +381,7 @@ class CommentData {
     /**
      * @brief The value of the comment
      */
-    String value;
+    SourceString value;
 
     /**
      * @brief Construct a new empty Comment Data object
@@ -218,7 +393,7 @@ class CommentData {
      *
      * @param value The value of the comment
      */
-    CommentData(String value);
+    CommentData(SourceString value);
 };
 
 /**
@@ -229,7 +404,7 @@ class IncludeData {
     /**
      * @brief The path to the file to include
      */
-    String path;
+    SourceString path;
 
     /**
      * @brief Construct a new empty Include Data object
@@ -241,11 +416,13 @@ class IncludeData {
      *
      * @param path The path to the file to include
      */
-    IncludeData(String path);
+    IncludeData(SourceString path);
 };
 
 /**
- * @brief A token in the source code
+ * @brief A token in the source code.
+ *        Only holds the data of its type, so tokens without data (eg: Indent)
+ *        don't construct any strings or vectors. Tokens are moved, not copied
  */
 class Token {
    public:
@@ -254,31 +431,20 @@ class Token {
      */
     TokenType type;
 
+   private:
     /**
-     * @brief Specific data for the Doctype Token
+     * @brief The data of the token, only the member of `type` is constructed.
+     *        Indent, Dedent, EndOfPart and EndOfSource tokens have no data
      */
-    DoctypeData doctype;
-
-    /**
-     * @brief Specific data for the Tag Token
-     */
-    TagData tag;
-
-    /**
-     * @brief Specific data for the Text Token
-     */
-    TextData text;
-
-    /**
-     * @brief Specific data for the Comment Token
-     */
-    CommentData comment;
-
-    /**
-     * @brief Specific data for the Include Token
-     */
-    IncludeData include;
+    union {
+        DoctypeData doctype_;
+        TagData tag_;
+        TextData text_;
+        CommentData comment_;
+        IncludeData include_;
+    };
 
+   public:
     /**
      * @brief Construct a new Generic Token object
      *
@@ -320,6 +486,115 @@ class Token {
      * @param data Data about the Include Token
      */
     Token(IncludeData data);
+
+    /**
+     * @brief Construct a new Token object by moving the data of another token
+     *
+     * @param token The token, keeps its type but its data is empty afterwards
+     */
+    Token(Token &&token);
+
+    Token(const Token &token) = delete;
+
+    /**
+     * @brief Destroy the Token object and its data
+     */
+    ~Token();
+
+    /**
+     * @brief Replace the token by moving the data of another token
+     *
+     * @param token The token, keeps its type but its data is empty afterwards
+     * @return Token& This token
+     */
+    Token &operator=(Token &&token);
+
+    Token &operator=(const Token &token) = delete;
+
+    /**
+     * @brief Specific data for the Doctype Token, only valid for TokenType::Doctype
+     *
+     * @return DoctypeData& The data
+     */
+    DoctypeData &doctype();
+
+    /**
+     * @brief Specific data for the Tag Token, only valid for TokenType::Tag
+     *
+     * @return TagData& The data
+     */
+    TagData &tag();
+
+    /**
+     * @brief Specific data for the Text Token, only valid for TokenType::Text
+     *
+     * @return TextData& The data
+     */
+    TextData &text();
+
+    /**
+     * @brief Specific data for the Comment Token, only valid for TokenType::Comment
+     *
+     * @return CommentData& The data
+     */
+    CommentData &comment();
+
+    /**
+     * @brief Specific data for the Include Token, only valid for TokenType::Include
+     *
+     * @return IncludeData& The data
+     */
+    IncludeData &include();
+
+   private:
+    /**
+     * @brief Construct the data of the type by moving the data of another token
+     *
+     * @param token The token with the same type
+     */
+    void moveData(Token &&token);
+
+    /**
+     * @brief Destroy the data of the type
+     */
+    void destroyData();
+};
+
+/**
+ * @brief Indent or Dedent Tokens of the same type in a row
+ */
+class TokenRun {
+   public:
+    /**
+     * @brief The type of the tokens, TokenType::Indent or TokenType::Dedent
+     */
+    TokenType type;
+
+    /**
+     * @brief Amount of tokens
+     */
+    size_t count;
+
+    /**
+     * @brief Construct a new empty Token Run object
+     */
+    TokenRun();
+
+    /**
+     * @brief Construct a new Token Run object
+     *
+     * @param type The type of the tokens
+     * @param count Amount of tokens
+     */
+    TokenRun(TokenType type, size_t count);
 };
 
+/**
+ * @brief Data that grows makes every token larger
+ */
+static_assert(
+    sizeof(Token) <= AALEC_PUG_TOKEN_MAX_SIZE,
+    "Token is larger than AALEC_PUG_TOKEN_MAX_SIZE"
+);
+
 #endif  // TOKEN_H